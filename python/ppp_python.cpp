@@ -0,0 +1,184 @@
+/**
+ *
+ * @file ppp_python.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ * @brief Python bindings of libppp.
+ *
+ * The matrices are read in place from NumPy arrays and SciPy CSR matrices,
+ * and the GIL is released while solving, so Python threads solve in parallel.
+ *
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <stdexcept>
+#include "ppp.hpp"
+
+namespace py = pybind11;
+
+namespace {
+
+/**
+  @brief Solve the dense matrix \e a, a 2-D array of bool or uint8, in place.
+*/
+ppp::Result solve_dense(const py::array &a, std::vector<size_t> active,
+                        const ppp::Options &options) {
+    if (a.ndim() != 2)
+        throw std::invalid_argument("the matrix must have 2 dimensions");
+
+    const char kind = a.dtype().kind();
+    if (a.itemsize() != 1 || (kind != 'b' && kind != 'u'))
+        throw py::type_error("the matrix must have dtype bool or uint8");
+
+    ppp::ByteMatrix m;
+    m.data = static_cast<const uint8_t *>(a.data());
+    m.num_species = a.shape(0);
+    m.num_characters = a.shape(1);
+    m.row_stride = a.strides(0);
+    m.col_stride = a.strides(1);
+    m.active = std::move(active);
+
+    // a is kept alive by the caller until solve returns
+    py::gil_scoped_release release;
+    return ppp::solve(m, options);
+}
+
+
+/**
+  @brief Solve the CSR matrix \e csr, whose index arrays have type T.
+
+  The index arrays are read in place if they are contiguous; explicit zeros
+  stored in the matrix are ignored.
+*/
+template <typename T>
+ppp::Result solve_csr(const py::object &csr, std::vector<size_t> active,
+                      const ppp::Options &options) {
+    typedef py::array_t<T, py::array::c_style | py::array::forcecast> IndexArray;
+    typedef py::array_t<bool, py::array::c_style | py::array::forcecast> DataArray;
+
+    const auto shape = csr.attr("shape").cast<std::pair<size_t, size_t>>();
+    const IndexArray indptr = IndexArray::ensure(py::object(csr.attr("indptr")));
+    const IndexArray indices = IndexArray::ensure(py::object(csr.attr("indices")));
+    const DataArray data = DataArray::ensure(py::object(csr.attr("data")));
+
+    if (!indptr || !indices || !data)
+        throw py::type_error("the CSR matrix has invalid arrays");
+
+    if (indptr.ndim() != 1 || static_cast<size_t>(indptr.shape(0)) != shape.first + 1 ||
+        indices.ndim() != 1 || data.ndim() != 1 || data.shape(0) != indices.shape(0))
+        throw std::invalid_argument("the CSR matrix has arrays of the wrong size");
+
+    const T *row_start = indptr.data(), *column = indices.data();
+    const bool *value = data.data();
+    const size_t nnz = indices.shape(0);
+
+    ppp::SparseMatrix m;
+    m.num_species = shape.first;
+    m.num_characters = shape.second;
+    m.active = std::move(active);
+
+    // the arrays are kept alive until the GIL is acquired again
+    py::gil_scoped_release release;
+
+    m.rows.resize(m.num_species);
+    for (size_t i = 0; i < m.num_species; ++i) {
+        if (row_start[i] < 0 || row_start[i] > row_start[i + 1] ||
+            static_cast<size_t>(row_start[i + 1]) > nnz)
+            throw std::invalid_argument("the CSR matrix has an invalid indptr");
+
+        for (T k = row_start[i]; k < row_start[i + 1]; ++k) {
+            if (column[k] < 0)
+                throw std::invalid_argument("the CSR matrix has a negative column");
+
+            if (value[k])
+                m.rows[i].push_back(column[k]);
+        }
+    }
+
+    return ppp::solve(m, options);
+}
+
+
+/**
+  @brief Solve \e matrix, a NumPy array or a SciPy CSR matrix, with the given
+  options.
+*/
+ppp::Result solve(const py::object &matrix, std::vector<size_t> active,
+                  const bool general, const bool exponential, const size_t threads,
+                  const bool preprocess, const bool memo,
+                  const std::string &cache_directory, const size_t timeout_ms) {
+    ppp::Options options;
+    options.general = general;
+    options.exponential = exponential;
+    options.threads = threads;
+    options.preprocess = preprocess;
+    options.memo = memo;
+    options.cache_directory = cache_directory;
+    options.timeout_ms = timeout_ms;
+
+    if (py::hasattr(matrix, "indptr") && py::hasattr(matrix, "indices")) {
+        // SciPy CSR matrix, checked by its format and not by importing SciPy
+        if (!py::hasattr(matrix, "format") || matrix.attr("format").cast<std::string>() != "csr")
+            throw py::type_error("only the CSR format of the sparse matrices is supported");
+
+        if (py::array(py::object(matrix.attr("indices"))).itemsize() == 4)
+            return solve_csr<int32_t>(matrix, std::move(active), options);
+
+        return solve_csr<int64_t>(matrix, std::move(active), options);
+    }
+
+    if (py::isinstance<py::array>(matrix))
+        return solve_dense(matrix.cast<py::array>(), std::move(active), options);
+
+    // any other sequence is converted to an array of uint8
+    const auto array = py::array_t<uint8_t, py::array::forcecast>::ensure(matrix);
+    if (!array)
+        throw py::type_error("the matrix must be a NumPy array or a SciPy CSR matrix");
+
+    return solve_dense(array, std::move(active), options);
+}
+
+}  // namespace
+
+
+PYBIND11_MODULE(ppp, m) {
+    m.doc() = "Persistent perfect phylogeny solver";
+
+    py::enum_<ppp::Status>(m, "Status")
+            .value("reduced", ppp::Status::reduced)
+            .value("not_reduced", ppp::Status::not_reduced)
+            .value("timeout", ppp::Status::timeout);
+
+    py::class_<ppp::SignedCharacter>(m, "SignedCharacter")
+            .def_readonly("character", &ppp::SignedCharacter::character,
+                          "Column of the character")
+            .def_readonly("gain", &ppp::SignedCharacter::gain,
+                          "True for c+, False for c-")
+            .def("__repr__", [](const ppp::SignedCharacter &sc) {
+                return "c" + std::to_string(sc.character) + (sc.gain ? "+" : "-");
+            });
+
+    py::class_<ppp::Result>(m, "Result")
+            .def_readonly("status", &ppp::Result::status)
+            .def_readonly("realized", &ppp::Result::realized,
+                          "Realized characters (until the deadline on timeout)")
+            .def_readonly("phase", &ppp::Result::phase,
+                          "Phase that was running on timeout")
+            .def("__repr__", [](const ppp::Result &r) {
+                return "<ppp.Result " + py::str(py::cast(r.status)).cast<std::string>() +
+                       " " + py::repr(py::cast(r.realized)).cast<std::string>() + ">";
+            });
+
+    m.def("solve", &solve,
+          "Run the algorithm on a matrix of species (rows) and characters (columns): "
+          "a 2-D NumPy array of bool or uint8, or a SciPy CSR matrix. "
+          "The matrix is read in place and the GIL is released while solving.",
+          py::arg("matrix"), py::arg("active") = std::vector<size_t>(),
+          py::arg("general") = false, py::arg("exponential") = false,
+          py::arg("threads") = 0, py::arg("preprocess") = false,
+          py::arg("memo") = true, py::arg("cache_directory") = "",
+          py::arg("timeout_ms") = 0);
+}
@@ -0,0 +1,58 @@
+# Client of the ppp solver daemon (ppp --serve SOCKET)
+import socket
+import struct
+import sys
+
+
+def to_binary(text):
+    # convert a matrix in the read_graph format to the binary format
+    lines = text.split('\n')
+    header = [int(x) for x in lines[0].split()]
+    num_s, num_c, active = header[0], header[1], header[2:]
+    values = [int(x) for line in lines[1:] for x in line.split()]
+
+    data = b'PPPB' + struct.pack('<III', num_s, num_c, len(active))
+    data += b''.join(struct.pack('<I', c) for c in active)
+    for i in range(num_s):
+        row = bytearray((num_c + 7) // 8)
+        for j in range(num_c):
+            if values[i * num_c + j]:
+                row[j // 8] |= 1 << (j % 8)
+        data += bytes(row)
+
+    return data
+
+
+def solve(path, data):
+    # one request per connection: send the matrix, then wait for the answer
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+        s.connect(path)
+        s.sendall(data)
+        s.shutdown(socket.SHUT_WR)
+
+        response = b''
+        while True:
+            chunk = s.recv(65536)
+            if not chunk:
+                break
+            response += chunk
+
+    return response.decode()
+
+
+if __name__ == '__main__':
+    args = sys.argv[1:]
+    binary = '--binary' in args
+    args = [a for a in args if a != '--binary']
+
+    if len(args) < 2:
+        print('usage: ppp_client.py [--binary] SOCKET FILE...', file=sys.stderr)
+        sys.exit(1)
+
+    for k in args[1:]:
+        with open(k, 'r') as f:
+            text = f.read()
+
+        data = to_binary(text) if binary else text.encode()
+        outcome, realized = (solve(args[0], data).split('\n') + ['', ''])[:2]
+        print(k, outcome, realized, sep='\t')
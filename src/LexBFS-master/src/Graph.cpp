@@ -9,27 +9,18 @@
 
 //N=number of nodes, M=number of edges
 Graph::Graph(int n, int m)
-        : Adj(n), E(m), n(n), m(m) {
-    //initialise the binary array A[n][n] with false values
-    A.resize(n);
-    for (int i = 0; i < n; i++) {
-        A[i].resize(n);
-    }
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            A[i][j] = false;
-        }
-    }
+        : Adj(n), n(n), m(m) {
+    E.reserve(m);    //edges are appended by insertEdge()
 }
 
 //Uses the fact that for chordal graphs to sort vertices directed by Lex-BFS is a perfect elimination scheme for the graph if G is chordal.
 //Algorithm 3 at page 6 of the paper by Habib, McConnell, Paul, Viennot.
 bool Graph::isChordal() {
-    int x, v;
-    unsigned int i, j;
+    int x, v, p;
+    unsigned int i;
     vector<vector<int> > RN(n +
                             1);    //values from 0 to n, not (n-1) because we need to compare with the root of the tree of parent pointers which will have the value n
-    int *parent = new int[n];
+    vector<int> parent(n);
     int *pi = Lex_BFS();
 
     //Build RN(x) and parent(x), such that RN(x) contains all the neighbours of x that are at right of x in the sequence pi, and parent(x) is the leftmost of them
@@ -46,103 +37,122 @@ bool Graph::isChordal() {
         }
     }
 
-    //Check whether RN(x)\parent[x] is contained in RN(parent[x])
-    bool isContained;
+    //group the vertices by parent, so that each RN(p) is marked once for all of its children
+    vector<vector<int> > children(n + 1);
     for (x = 0; x < n; x++) {
-        for (i = 0; i < RN[x].size(); i++) {
-            if (RN[x][i] == parent[x]) {    //skip the node parent[x]
-                continue;
-            }
+        children[parent[x]].push_back(x);
+    }
 
-            isContained = false;
-            for (j = 0; j < RN[parent[x]].size(); j++) {
-                if (RN[x][i] == RN[parent[x]][j]) {
-                    isContained = true;
-                    break;
-                }
-            }
+    //Check whether RN(x)\parent[x] is contained in RN(parent[x])
+    //mark[v] == p means that v belongs to RN(p), so every containment test costs O(|RN(x)|)
+    vector<int> mark(n, -1);
+    for (p = 0; p < n; p++) {
+        if (children[p].empty()) {
+            continue;
+        }
 
-            if (!isContained) {
-                //cleanup pointers before returning from the function
-                delete pi;
-                delete parent;
+        for (i = 0; i < RN[p].size(); i++) {
+            mark[RN[p][i]] = p;
+        }
 
-                return false;    //chordality test fails!
+        for (unsigned int c = 0; c < children[p].size(); c++) {
+            x = children[p][c];
+            for (i = 0; i < RN[x].size(); i++) {
+                if (RN[x][i] != p && mark[RN[x][i]] != p) {    //skip the node parent[x]
+                    delete[] pi;    //cleanup pointers before returning from the function
+                    return false;    //chordality test fails!
+                }
             }
         }
     }
 
     //cleanup pointers before returning from the function
-    delete pi;
-    delete parent;
+    delete[] pi;
 
     return true;    //chordality test passes!
 }
 
 //implemented according to the LexBFS algorithm described in page 5 of the paper by Habib, McConnell, Paul, Veinnot.
+//The ordered partition L is kept in a single array of vertices, in which every class is a contiguous range:
+//refining a class moves its members adjacent to x to the front of the range and then splits the range in two,
+//so each visited vertex costs O(degree) and the whole search runs in O(n+m)
 int *Graph::Lex_BFS() {
     int *pi = new int[n + 1];
-    List::iterator it;
-    vector<iListS> pos;
-    int u, x, i;
-    ListS L;
-    List *S, *Y;
-    iListS X;
-
-    //init S with all the vertices
-    S = new List();
-    for (u = 0; u < n; u++) {
-        S->push_back(u);
-    }
+    vector<int> order(n);        //vertices, classes of L are contiguous ranges from left to right
+    vector<int> position(n);    //position[u] is the index of u in order
+    vector<int> classOf(n);        //classOf[u] is the class containing u
+    vector<int> classStart;        //classStart[c] is the index of the first vertex of class c in order
+    vector<int> classEnd;        //classEnd[c] is the index after the last vertex of class c in order
+    vector<int> classMoved;        //classMoved[c] is the number of vertices of class c adjacent to x
+    vector<int> touched;        //classes containing some vertex adjacent to x
+    int u, x, i, c, next;
 
     //L=(V); //L receives an ordered set of vertices (V)
-    L.push_back(S);
+    for (u = 0; u < n; u++) {
+        order[u] = u;
+        position[u] = u;
+        classOf[u] = 0;
+    }
+    classStart.push_back(0);
+    classEnd.push_back(n);
+    classMoved.push_back(0);
 
     pi[n] = n;
     i = n - 1;
 
-    while (!L.empty()) {
-        S = L.front();
-        x = S->front();
-        S->pop_front();
-        if (S->empty()) { //if S becomes empty
-            L.pop_front(); //remove it from the container
-            delete S;
-        }
+    for (next = 0; next < n; next++) {
+        //x receives the first element of the first class composed of unvisited vertices
+        x = order[next];
+        classStart[classOf[x]]++;
 
-        //x receives the first element of the last class composed of unvisited vertices Xa
         pi[x] = i;
         i--;
 
-        //refinement of each partition X in L
-        for (X = L.begin(); X != L.end();) { //for each class Xb with b<=a do:
-            Y = new List(); //Y is the members of Xb that are adjacent to x
-            S = *X;
-
-            //Find members in Xb that are adjacent to x and add them into Y
-            for (it = S->begin(); it != S->end();) {
-                if (A[x][*it]) {
-                    Y->push_back(*it);
-                    it = S->erase(it);
-                } else {
-                    it++;
-                }
+        //move the unvisited neighbours of x to the front of their class
+        for (unsigned int k = 0; k < degree(x); k++) {
+            u = getIthNeighbour(x, k);
+            if (position[u] <= next) {    //already visited (or x itself)
+                continue;
+            }
+
+            c = classOf[u];
+            int front = classStart[c] + classMoved[c];
+            if (position[u] < front) {    //already moved (parallel edge)
+                continue;
+            }
+
+            if (classMoved[c] == 0) {
+                touched.push_back(c);
             }
 
-            //If Y is non-empty, insert before Xb (Y will be containing neighbouring vertices)
-            if (Y->size() > 0) {
-                L.insert(X, Y);
-            } else {
-                delete Y;
+            int w = order[front];
+            order[front] = u;
+            order[position[u]] = w;
+            position[w] = position[u];
+            position[u] = front;
+            classMoved[c]++;
+        }
+
+        //split each refined class Xb into (Y, Xb\Y), where Y are the members of Xb adjacent to x
+        for (unsigned int k = 0; k < touched.size(); k++) {
+            c = touched[k];
+            int moved = classMoved[c];
+            classMoved[c] = 0;
+
+            if (classStart[c] + moved == classEnd[c]) {    //Y == Xb, nothing to split
+                continue;
             }
 
-            //check if S became empty, remove Xb from the list L
-            if (S->size() == 0) {
-                X = L.erase(X);
-            } else {
-                X++;
+            int y = classStart.size();
+            classStart.push_back(classStart[c]);
+            classEnd.push_back(classStart[c] + moved);
+            classMoved.push_back(0);
+            for (int j = classStart[c]; j < classStart[c] + moved; j++) {
+                classOf[order[j]] = y;
             }
+            classStart[c] += moved;
         }
+        touched.clear();
     }
 
     return pi;
@@ -9,7 +9,6 @@
 #define GRAPH_H_
 
 #include <cstdio>
-#include <list>
 #include <vector>    //for vectors
 
 using namespace std;
@@ -17,16 +16,12 @@ using namespace std;
 #include "Edge.h"
 
 typedef vector<int> Ladj;
-typedef list<int> List;
-typedef list<List *> ListS;
-typedef ListS::iterator iListS;
 
 struct Graph {
 
 private:
     vector<Ladj> Adj;
     vector<Edge> E;
-    vector<vector<bool> > A; //being used in Lex_BFS() function for quickly identifying whether vertices are adjacent or no
     int n, m;
 
 public:
@@ -41,7 +36,6 @@ public:
         E.push_back(Edge(u, v));
         Adj[u].push_back(i);
         Adj[v].push_back(i); //if G is an undirected graph
-        A[u][v] = A[v][u] = true;
     }
 
     //degree of vertex u
@@ -56,8 +50,8 @@ public:
         return E[Adj[u][i]].otherEnd(u);
     }
 
-    int *Lex_BFS(); //execute Lex-BFS in graph
-    bool isChordal(); //check if graph is chordal
+    int *Lex_BFS(); //execute Lex-BFS in graph, O(n+m)
+    bool isChordal(); //check if graph is chordal, O(n+m)
     void print(); //print the graph
 };
 
@@ -32,6 +32,17 @@ SparseMatrix::SparseMatrix(bool *binaryMatrix, int rows, int cols) {
     }
 }
 
+//builds the cliques directly from the sparse columns, without going through a dense rows x cols matrix
+//assumption: the rows of each column appear in an ascending order
+SparseMatrix::SparseMatrix(const vector<vector<unsigned int> > &columns, int rows) {
+    numofCliques = columns.size();
+    numofVertices = rows;
+    sparseCliques.resize(numofCliques);
+    for (unsigned int i = 0; i < numofCliques; ++i) {
+        sparseCliques[i].getVertices() = columns[i];
+    }
+}
+
 SparseMatrix::~SparseMatrix() {
 }
 
@@ -44,8 +55,13 @@ void SparseMatrix::printMatrix() {
     }
 }
 
-//implementation of the algorithm 8 (using algorithm 10) after appending the identity matrix below
 bool SparseMatrix::hasConsecutiveOnesProperty() {
+    vector<int> columnOrder;
+    return hasConsecutiveOnesProperty(columnOrder);
+}
+
+//implementation of the algorithm 8 (using algorithm 10) after appending the identity matrix below
+bool SparseMatrix::hasConsecutiveOnesProperty(vector<int> &columnOrder) {
     appendIdentityMatrix();        //append the identity matrix below the actual matrix (to make sure the cliques are maximal)
     //printf("Extended matrix M~:\n");
     //printMatrix();
@@ -340,6 +356,14 @@ bool SparseMatrix::hasConsecutiveOnesProperty() {
 
     }    //end of the while() loop, algorithm 8
 
+    //save the final sequence of the matrix columns
+    columnOrder.clear();
+    for (unsigned int i = 0; i < L.size(); ++i) {
+        if (!L[i].empty()) {
+            columnOrder.push_back(L[i][0]->id);
+        }
+    }
+
     //print out the final sequence of the matrix columns
     /*printf("The reordered columns sequence: ");
     for (unsigned int i=0; i<L.size(); ++i) {
@@ -36,11 +36,15 @@ public:
 
     SparseMatrix(bool *binaryMatrix, int rows, int cols);
 
+    SparseMatrix(const vector<vector<unsigned int> > &columns, int rows);    //columns[i] lists the rows with a 1 in column i
+
     virtual ~SparseMatrix();
 
     void printMatrix();
 
     bool hasConsecutiveOnesProperty();
+
+    bool hasConsecutiveOnesProperty(vector<int> &columnOrder);    //columnOrder receives the reordered columns sequence
 };
 
 #endif /* SPARSEMATRIX_H_ */
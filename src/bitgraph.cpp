@@ -0,0 +1,690 @@
+/**
+ *
+ * @file bitgraph.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "bitgraph.hpp"
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+namespace {
+
+/**
+  @brief Call \e f with the index of each bit set in the \e n words \e w .
+*/
+template <typename F>
+void for_each_bit(const uint64_t *w, const size_t n, F f) {
+    for (size_t k = 0; k < n; ++k)
+        for (uint64_t word = w[k]; word != 0; word &= word - 1)
+            f(k * 64 + __builtin_ctzll(word));
+}
+
+
+/**
+  @brief Return true if the \e n words \e a and \e b have a bit set in common.
+*/
+bool intersects(const uint64_t *a, const uint64_t *b, const size_t n) {
+    for (size_t k = 0; k < n; ++k)
+        if (a[k] & b[k])
+            return true;
+
+    return false;
+}
+
+
+/**
+  @brief Return the columns with a black edge in \e b .
+*/
+std::vector<uint64_t> black_columns(const BitGraph &b) {
+    const size_t words = b.row_words();
+
+    std::vector<uint64_t> black(words, 0);
+    for (size_t i = 0; i < b.num_rows(); ++i)
+        for (size_t k = 0; k < words; ++k)
+            black[k] |= b.ones[i * words + k] & ~b.red[i * words + k];
+
+    return black;
+}
+
+
+/**
+  @brief Return the number of edges of the character of column \e c in \e b .
+*/
+size_t degree(const size_t c, const BitGraph &b) {
+    size_t count = 0;
+    for (size_t i = 0; i < b.num_rows(); ++i)
+        count += b.get(b.ones, i, c);
+
+    return count;
+}
+
+
+/**
+  @brief Return the rows of the connected component of the character of
+  column \e c in \e b, in the order of the rows.
+
+  The columns reached so far are kept as a mask, and the rows are scanned
+  until no row with one of them is left.
+*/
+std::vector<size_t> component_rows(const size_t c, const BitGraph &b) {
+    const size_t words = b.row_words();
+
+    std::vector<uint64_t> columns(words, 0);
+    columns[c / 64] |= uint64_t(1) << (c % 64);
+
+    std::vector<bool> reached(b.num_rows(), false);
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (size_t i = 0; i < b.num_rows(); ++i) {
+            const uint64_t *row = b.ones.data() + i * words;
+            if (reached[i] || !intersects(row, columns.data(), words))
+                continue;
+
+            reached[i] = true;
+            grown = true;
+            for (size_t k = 0; k < words; ++k)
+                columns[k] |= row[k];
+        }
+    }
+
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < b.num_rows(); ++i)
+        if (reached[i])
+            rows.push_back(i);
+
+    return rows;
+}
+
+
+/**
+  @brief Struct used to represent the connected components of a bit graph
+*/
+struct ComponentLabels {
+    size_t count{};                ///< Number of components
+    std::vector<size_t> row{};     ///< Component of each row
+    std::vector<size_t> column{};  ///< Component of each column of a character in the graph
+};
+
+
+/**
+  @brief Label the connected components of \e b .
+
+  The columns of each row are merged in a union-find; the components are
+  numbered by their first row, and the characters with no edges follow.
+*/
+ComponentLabels label_components(const BitGraph &b) {
+    const size_t words = b.row_words(), num_cols = b.character_names.size();
+
+    std::vector<size_t> parent(num_cols);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](size_t j) {
+        while (parent[j] != j)
+            j = parent[j] = parent[parent[j]];
+        return j;
+    };
+
+    std::vector<size_t> first(b.num_rows(), num_cols);
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        for_each_bit(b.ones.data() + i * words, words, [&](const size_t j) {
+            if (first[i] == num_cols)
+                first[i] = j;
+            else
+                parent[find(j)] = find(first[i]);
+        });
+    }
+
+    const size_t none = SIZE_MAX;
+    ComponentLabels labels;
+    labels.row.resize(b.num_rows());
+    labels.column.assign(num_cols, none);
+
+    std::vector<size_t> root_label(num_cols, none);
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        if (first[i] == num_cols) {
+            // a species with no edges
+            labels.row[i] = labels.count++;
+            continue;
+        }
+
+        size_t &label = root_label[find(first[i])];
+        if (label == none)
+            label = labels.count++;
+        labels.row[i] = label;
+    }
+
+    for (size_t j = 0; j < num_cols; ++j) {
+        if (!b.has_character(j))
+            continue;
+
+        size_t &label = root_label[find(j)];
+        if (label == none)
+            // a character with no edges
+            label = labels.count++;
+        labels.column[j] = label;
+    }
+
+    return labels;
+}
+
+
+/**
+  @brief Keep the rows \e i of \e b with keep[i] true, in the same order.
+*/
+void erase_rows(BitGraph &b, const std::vector<bool> &keep) {
+    const size_t words = b.row_words();
+
+    size_t rows = 0;
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        if (!keep[i])
+            continue;
+
+        if (rows != i) {
+            std::copy_n(b.ones.data() + i * words, words, b.ones.data() + rows * words);
+            std::copy_n(b.red.data() + i * words, words, b.red.data() + rows * words);
+            b.species_names[rows] = std::move(b.species_names[i]);
+        }
+        ++rows;
+    }
+
+    b.ones.resize(rows * words);
+    b.red.resize(rows * words);
+    b.species_names.resize(rows);
+}
+
+
+/**
+  @brief Remove the character of column \e c from the rows of \e b .
+*/
+void clear_column(const size_t c, BitGraph &b) {
+    const size_t words = b.row_words();
+    const uint64_t mask = ~(uint64_t(1) << (c % 64));
+
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        b.ones[i * words + c / 64] &= mask;
+        b.red[i * words + c / 64] &= mask;
+    }
+}
+
+
+/**
+  @brief Return the red-universal and universal characters of \e b, as
+  universal_characters(g).
+*/
+std::list<SignedCharacter> universal_characters(const BitGraph &b) {
+    const size_t words = b.row_words();
+    const ComponentLabels labels = label_components(b);
+
+    // number of species in each connected component
+    std::vector<size_t> comp_species(labels.count, 0);
+    for (size_t i = 0; i < b.num_rows(); ++i)
+        ++comp_species[labels.row[i]];
+
+    std::vector<size_t> degree(b.character_names.size(), 0), black_degree(degree);
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        for_each_bit(b.ones.data() + i * words, words, [&](const size_t j) {
+            ++degree[j];
+            black_degree[j] += !b.get(b.red, i, j);
+        });
+    }
+
+    std::list<SignedCharacter> output;
+    for (size_t j = 0; j < b.character_names.size(); ++j) {
+        if (!b.has_character(j) || degree[j] != comp_species[labels.column[j]])
+            continue;
+        // j is connected to all the species of its component
+
+        if (black_degree[j] > 0)
+            // j is universal
+            output.push_back({b.character_names[j], State::gain});
+        else
+            // j is red-universal
+            output.push_back({b.character_names[j], State::lose});
+    }
+
+    return output;
+}
+
+}  // namespace
+
+
+size_t BitGraph::add_species(const std::string &name) {
+    species_names.push_back(name);
+    ones.resize(ones.size() + row_words(), 0);
+    red.resize(red.size() + row_words(), 0);
+
+    return num_rows() - 1;
+}
+
+
+size_t BitGraph::add_character(const std::string &name) {
+    const size_t old_words = row_words();
+    character_names.push_back(name);
+    const size_t words = row_words();
+
+    if (words != old_words) {
+        // widen the rows by a word
+        std::vector<uint64_t> new_ones(num_rows() * words, 0), new_red(new_ones);
+        for (size_t i = 0; i < num_rows(); ++i) {
+            std::copy_n(ones.data() + i * old_words, old_words, new_ones.data() + i * words);
+            std::copy_n(red.data() + i * old_words, old_words, new_red.data() + i * words);
+        }
+
+        ones.swap(new_ones);
+        red.swap(new_red);
+        characters.resize(words, 0);
+    }
+
+    const size_t j = character_names.size() - 1;
+    characters[j / 64] |= uint64_t(1) << (j % 64);
+
+    return j;
+}
+
+
+void BitGraph::add_edge(const size_t i, const size_t j, const Color color) {
+    const uint64_t bit = uint64_t(1) << (j % 64);
+    const size_t k = i * row_words() + j / 64;
+
+    ones[k] |= bit;
+    if (color == Color::red)
+        red[k] |= bit;
+    else
+        red[k] &= ~bit;
+}
+
+
+void BitGraph::clear() {
+    ones.clear();
+    red.clear();
+    characters.clear();
+    species_names.clear();
+    character_names.clear();
+}
+
+
+void build_bitgraph(const RBGraph &g, BitGraph &b) {
+    b.clear();
+
+    std::map<RBVertex, size_t> column;
+    for (RBVertex v : g.m_vertices)
+        if (is_character(v, g))
+            column[v] = b.add_character(g[v].name);
+
+    for (RBVertex v : g.m_vertices) {
+        if (!is_species(v, g))
+            continue;
+
+        const size_t i = b.add_species(g[v].name);
+
+        RBOutEdgeIter e, e_end;
+        std::tie(e, e_end) = out_edges(v, g);
+        for (; e != e_end; ++e)
+            b.add_edge(i, column.at(e->m_target), g[*e].color);
+    }
+}
+
+
+void build_graph(const BitGraph &b, RBGraph &g) {
+    std::vector<RBVertex> species(b.num_rows()), characters(b.character_names.size());
+
+    // insert species in the graph
+    for (size_t i = 0; i < b.num_rows(); ++i)
+        species[i] = add_species(b.species_names[i], g);
+
+    // insert characters in the graph
+    for (size_t j = 0; j < b.character_names.size(); ++j)
+        if (b.has_character(j))
+            characters[j] = add_character(b.character_names[j], g);
+
+    // add an edge for each bit of the rows
+    const size_t words = b.row_words();
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        for_each_bit(b.ones.data() + i * words, words, [&](const size_t j) {
+            add_edge(species[i], characters[j], b.get(b.red, i, j) ? Color::red : Color::black, g);
+        });
+    }
+}
+
+
+size_t num_characters(const BitGraph &b) {
+    size_t count = 0;
+    for (const uint64_t word : b.characters)
+        count += __builtin_popcountll(word);
+
+    return count;
+}
+
+
+bool is_empty(const BitGraph &b) {
+    return (b.num_rows() == 0 && num_characters(b) == 0);
+}
+
+
+size_t get_character(const std::string &name, const BitGraph &b) {
+    for (size_t j = 0; j < b.character_names.size(); ++j)
+        if (b.has_character(j) && b.character_names[j] == name)
+            return j;
+
+    throw std::out_of_range("[ERROR] In get_character(): no character " + name);
+}
+
+
+void remove_singletons(BitGraph &b) {
+    const size_t words = b.row_words();
+
+    std::vector<uint64_t> used(words, 0);
+    std::vector<bool> keep(b.num_rows());
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        for (size_t k = 0; k < words; ++k) {
+            used[k] |= b.ones[i * words + k];
+            keep[i] = keep[i] || b.ones[i * words + k] != 0;
+        }
+    }
+
+    for (size_t k = 0; k < words; ++k)
+        b.characters[k] &= used[k];
+
+    erase_rows(b, keep);
+}
+
+
+bool is_active(const size_t c, const BitGraph &b) {
+    // an active character has only red edges
+    for (size_t i = 0; i < b.num_rows(); ++i)
+        if (b.get(b.ones, i, c) && !b.get(b.red, i, c))
+            return false;
+
+    return true;
+}
+
+
+bool is_red_universal(const size_t c, const BitGraph &b) {
+    if (!is_active(c, b))
+        return false;
+
+    for (const size_t i : component_rows(c, b))
+        if (!b.get(b.ones, i, c))
+            return false;
+
+    return true;
+}
+
+
+bool is_universal(const size_t c, const BitGraph &b) {
+    if (is_active(c, b))
+        return false;
+
+    for (const size_t i : component_rows(c, b))
+        if (!b.get(b.ones, i, c))
+            return false;
+
+    return true;
+}
+
+
+void remove_duplicate_species(BitGraph &b) {
+    const size_t words = b.row_words();
+
+    // sort the rows by their words, and by index among equal rows
+    auto compare = [&b, words](const size_t x, const size_t y) {
+        for (const std::vector<uint64_t> *plane : {&b.ones, &b.red}) {
+            const uint64_t *row_x = plane->data() + x * words, *row_y = plane->data() + y * words;
+            for (size_t k = 0; k < words; ++k)
+                if (row_x[k] != row_y[k])
+                    return row_x[k] < row_y[k];
+        }
+        return false;
+    };
+
+    std::vector<size_t> order(b.num_rows());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), compare);
+
+    // keep the first row of each group of equal rows
+    std::vector<bool> keep(b.num_rows(), true);
+    for (size_t k = 1; k < order.size(); ++k)
+        if (!compare(order[k - 1], order[k]))
+            keep[order[k]] = false;
+
+    erase_rows(b, keep);
+}
+
+
+bool has_red_sigmagraph(const BitGraph &b) {
+    const size_t words = b.row_words(), num_cols = b.character_names.size();
+
+    // active characters
+    std::vector<uint64_t> active = black_columns(b);
+    size_t count_actives = 0;
+    for (size_t k = 0; k < words; ++k) {
+        active[k] = b.characters[k] & ~active[k];
+        count_actives += __builtin_popcountll(active[k]);
+    }
+
+    // if count_actives doesn't reach 2, b can't contain a red sigma-graph
+    if (count_actives < 2)
+        return false;
+
+    // for each active character j: shared[j] are the active characters of
+    // some species of j, common[j] the ones of every species of j
+    std::vector<uint64_t> shared(num_cols * words, 0), common(num_cols * words, ~uint64_t(0));
+    std::vector<uint64_t> row(words);
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        for (size_t k = 0; k < words; ++k)
+            row[k] = b.ones[i * words + k] & active[k];
+
+        for_each_bit(row.data(), words, [&](const size_t j) {
+            for (size_t k = 0; k < words; ++k) {
+                shared[j * words + k] |= row[k];
+                common[j * words + k] &= row[k];
+            }
+        });
+    }
+
+    // j and l induce a red sigma-graph if l shares a species with j, some
+    // species of j lack l, and some species of l lack j
+    bool found = false;
+    for_each_bit(active.data(), words, [&](const size_t j) {
+        if (found)
+            return;
+
+        for (size_t k = 0; k < words && !found; ++k) {
+            const uint64_t candidates = shared[j * words + k] & ~common[j * words + k];
+            for_each_bit(&candidates, 1, [&](const size_t l) {
+                const size_t c = k * 64 + l;
+                if (!((common[c * words + j / 64] >> (j % 64)) & 1))
+                    found = true;
+            });
+        }
+    });
+
+    return found;
+}
+
+
+BitGraphVector connected_components(const BitGraph &b) {
+    const ComponentLabels labels = label_components(b);
+
+    BitGraphVector components(labels.count);
+    for (auto &component : components)
+        component = std::make_unique<BitGraph>();
+
+    if (labels.count <= 1)
+        // b is connected
+        return components;
+
+    // add the characters, then the species with their edges
+    std::vector<size_t> column(b.character_names.size());
+    for (size_t j = 0; j < b.character_names.size(); ++j)
+        if (b.has_character(j))
+            column[j] = components[labels.column[j]]->add_character(b.character_names[j]);
+
+    const size_t words = b.row_words();
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        BitGraph &component = *components[labels.row[i]];
+        const size_t row = component.add_species(b.species_names[i]);
+
+        for_each_bit(b.ones.data() + i * words, words, [&](const size_t j) {
+            component.add_edge(row, column[j], b.get(b.red, i, j) ? Color::red : Color::black);
+        });
+    }
+
+    return components;
+}
+
+
+std::pair<std::list<SignedCharacter>, bool>
+realize_character(const SignedCharacter &sc, BitGraph &b) {
+    std::list<SignedCharacter> output;
+
+    size_t c;
+    try {
+        c = get_character(sc.character, b);
+    } catch (const std::out_of_range &e) {
+        // b has no character sc.character
+        return std::make_pair(output, false);
+    }
+
+    const std::vector<size_t> rows = component_rows(c, b);
+    const size_t words = b.row_words();
+    const uint64_t bit = uint64_t(1) << (c % 64);
+
+    if (sc.state == State::gain && is_inactive(c, b)) {
+        // realize the character c+: complement its column in its component,
+        // the new edges being red
+        for (const size_t i : rows) {
+            uint64_t &ones = b.ones[i * words + c / 64], &red = b.red[i * words + c / 64];
+            ones ^= bit;
+            red = (red & ~bit) | (ones & bit);
+        }
+    } else if (sc.state == State::lose && is_active(c, b) && rows.size() == degree(c, b)) {
+        // realize the character c-, connected to all the species of its
+        // component: clear its column
+        clear_column(c, b);
+    } else {
+        return std::make_pair(output, false);
+    }
+
+    output.push_back(sc);
+
+    // delete all isolated vertices
+    remove_singletons(b);
+
+    return std::make_pair(output, true);
+}
+
+
+std::pair<std::list<SignedCharacter>, bool>
+realize(const std::list<SignedCharacter> &lsc, BitGraph &b) {
+    std::list<SignedCharacter> output;
+
+    const size_t words = b.row_words();
+
+    bool feasible = true, missing = false;
+    for (const SignedCharacter &i : lsc) {
+        if (std::find(output.cbegin(), output.cend(), i) != output.cend()) {
+            // the signed character i has already been realized in a previous sc
+            continue;
+        }
+
+        // a character left with no edges by a realization counts as deleted
+        size_t c = 0;
+        try {
+            c = get_character(i.character, b);
+            missing = (!output.empty() && degree(c, b) == 0);
+        } catch (const std::out_of_range &e) {
+            missing = true;
+        }
+        if (missing)
+            break;
+
+        const std::vector<size_t> rows = component_rows(c, b);
+        const uint64_t bit = uint64_t(1) << (c % 64);
+
+        if (i.state == State::gain && is_inactive(c, b)) {
+            // realize the character c+ (see realize_character)
+            for (const size_t s : rows) {
+                uint64_t &ones = b.ones[s * words + c / 64], &red = b.red[s * words + c / 64];
+                ones ^= bit;
+                red = (red & ~bit) | (ones & bit);
+            }
+        } else if (i.state == State::lose && is_active(c, b) && rows.size() == degree(c, b)) {
+            // realize the character c- (see realize_character)
+            clear_column(c, b);
+        } else {
+            feasible = false;
+            break;
+        }
+
+        output.push_back(i);
+    }
+
+    if (!output.empty())
+        // delete all isolated vertices
+        remove_singletons(b);
+
+    if (missing)
+        throw std::runtime_error("[ERROR] In realize(): vertex does not exist");
+
+    if (!feasible)
+        return std::make_pair(std::list<SignedCharacter>(), false);
+
+    return std::make_pair(output, true);
+}
+
+
+std::pair<std::list<SignedCharacter>, bool> realize_species(const size_t s, BitGraph &b) {
+    std::list<SignedCharacter> lsc;
+
+    if (s >= b.num_rows())
+        return std::make_pair(lsc, false);
+
+    // the inactive characters of s are its columns with a black edge
+    const size_t words = b.row_words();
+    const std::vector<uint64_t> inactive = black_columns(b);
+    for (size_t k = 0; k < words; ++k) {
+        const uint64_t word = b.ones[s * words + k] & inactive[k];
+        for_each_bit(&word, 1, [&](const size_t j) {
+            lsc.push_back({b.character_names[k * 64 + j], State::gain});
+        });
+    }
+
+    return realize(lsc, b);
+}
+
+
+std::pair<std::list<SignedCharacter>, bool> realize_red_univ_and_univ_chars(BitGraph &b) {
+    std::list<SignedCharacter> output;
+
+    // as in realize_red_univ_and_univ_chars(g), the characters are realized
+    // as a batch until no batch is left
+    std::list<SignedCharacter> lsc = universal_characters(b);
+    while (!lsc.empty()) {
+        // the characters with no edges are deleted with the isolated vertices,
+        // and only the first one is realized if it comes before the others
+        for (auto sc = std::next(lsc.begin()); sc != lsc.end();) {
+            if (degree(get_character(sc->character, b), b) == 0)
+                sc = lsc.erase(sc);
+            else
+                ++sc;
+        }
+
+        // each character is connected to all the species of its component,
+        // so realizing c+ or c- deletes all its edges
+        for (const SignedCharacter &sc : lsc)
+            clear_column(get_character(sc.character, b), b);
+
+        // delete all isolated vertices
+        remove_singletons(b);
+
+        output.splice(output.cend(), lsc);
+        lsc = universal_characters(b);
+    }
+
+    return std::make_pair(output, !output.empty());
+}
@@ -0,0 +1,301 @@
+/**
+ *
+ * @file bitgraph.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef BITGRAPH_HPP
+#define BITGRAPH_HPP
+
+#include <cstdint>
+#include "functions.hpp"
+
+//=============================================================================
+// Data structures
+
+
+/**
+  @brief Struct used to represent a red-black graph as a packed bit matrix
+
+  Row i is a species and column j is a character. Each row is stored in two
+  planes of row_words() words: \e ones has the bits of the edges of the
+  species, and \e red the bits of its red edges. Realizing c+ complements the
+  column of c on the rows of its connected component, and realizing c- clears
+  the column of c, so every operation works on whole words of the rows.
+
+  A removed species is erased with its row; a removed character keeps its
+  column, which is empty, and is cleared from \e characters .
+*/
+struct BitGraph {
+    std::vector<uint64_t> ones{};        ///< Edges of each row, row_words() words per row
+    std::vector<uint64_t> red{};         ///< Red edges of each row, row_words() words per row
+    std::vector<uint64_t> characters{};  ///< Columns of the characters in the graph, row_words() words
+
+    std::vector<std::string> species_names{};    ///< Name of the species of each row
+    std::vector<std::string> character_names{};  ///< Name of the character of each column
+
+    /**
+      @brief Return the number of words of a row.
+    */
+    size_t row_words() const { return (character_names.size() + 63) / 64; }
+
+    /**
+      @brief Return the number of rows (species).
+    */
+    size_t num_rows() const { return species_names.size(); }
+
+    /**
+      @brief Return the bit of row \e i and column \e j in the plane \e plane .
+    */
+    bool get(const std::vector<uint64_t> &plane, const size_t i, const size_t j) const {
+        return (plane[i * row_words() + j / 64] >> (j % 64)) & 1;
+    }
+
+    /**
+      @brief Return true if the character of column \e j is in the graph.
+    */
+    bool has_character(const size_t j) const {
+        return (characters[j / 64] >> (j % 64)) & 1;
+    }
+
+    /**
+      @brief Add a species with no edges, and return its row.
+    */
+    size_t add_species(const std::string &name);
+
+    /**
+      @brief Add a character with no edges, and return its column.
+
+      The rows are widened by a word every 64 characters.
+    */
+    size_t add_character(const std::string &name);
+
+    /**
+      @brief Add an edge of color \e color between the species of row \e i and
+      the character of column \e j .
+    */
+    void add_edge(size_t i, size_t j, Color color);
+
+    /**
+      @brief Empty the graph, keeping the capacity of its buffers.
+    */
+    void clear();
+};
+
+
+/**
+  Vector of unique pointers to bit graphs, one per connected component
+*/
+typedef std::vector<std::unique_ptr<BitGraph>> BitGraphVector;
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Build the bit graph \e b of the red-black graph \e g .
+
+  The rows follow the order of the species of \e g and the columns the order
+  of its characters, so the functions on \e b visit species and characters in
+  the same order as the functions on \e g .
+
+  @param[in]  g Red-black graph
+  @param[out] b Bit graph
+*/
+void build_bitgraph(const RBGraph &g, BitGraph &b);
+
+
+/**
+  @brief Build the red-black graph \e g of the bit graph \e b .
+
+  @param[in]  b Bit graph
+  @param[out] g Red-black graph
+*/
+void build_graph(const BitGraph &b, RBGraph &g);
+
+
+/**
+  @brief Copy the bit graph \e b in \e b_copy .
+
+  @param[in]  b      Bit graph
+  @param[out] b_copy Copy of b
+*/
+inline void copy_graph(const BitGraph &b, BitGraph &b_copy) { b_copy = b; }
+
+
+/**
+  @brief Return the number of species in \e b .
+*/
+inline size_t num_species(const BitGraph &b) { return b.num_rows(); }
+
+
+/**
+  @brief Return the number of characters in \e b .
+*/
+size_t num_characters(const BitGraph &b);
+
+
+/**
+  @brief Return true if \e b has no species and no characters.
+*/
+bool is_empty(const BitGraph &b);
+
+
+/**
+  @brief Return the column of the character \e name in \e b .
+
+  @throws std::out_of_range if \e b has no character \e name
+*/
+size_t get_character(const std::string &name, const BitGraph &b);
+
+
+/**
+  @brief Remove the species with no edges and the characters with no edges
+  from \e b .
+
+  @param[in,out] b Bit graph
+*/
+void remove_singletons(BitGraph &b);
+
+
+/**
+  @brief Return true if the character of column \e c is active in \e b, as
+  is_active(v, g): it has no black edges.
+
+  @param[in] c Column of a character
+  @param[in] b Bit graph
+
+  @return bool
+*/
+bool is_active(size_t c, const BitGraph &b);
+
+
+/**
+  @brief Return true if the character of column \e c is inactive in \e b .
+*/
+inline bool is_inactive(const size_t c, const BitGraph &b) { return !is_active(c, b); }
+
+
+/**
+  @brief Return true if the character of column \e c is red-universal in \e b,
+  as is_red_universal(v, g): it is active and connected to all the species of
+  its connected component.
+
+  @param[in] c Column of a character
+  @param[in] b Bit graph
+
+  @return bool
+*/
+bool is_red_universal(size_t c, const BitGraph &b);
+
+
+/**
+  @brief Return true if the character of column \e c is universal in \e b, as
+  is_universal(v, g): it is inactive and connected to all the species of its
+  connected component.
+
+  @param[in] c Column of a character
+  @param[in] b Bit graph
+
+  @return bool
+*/
+bool is_universal(size_t c, const BitGraph &b);
+
+
+/**
+  @brief Remove the duplicate species from \e b, as remove_duplicate_species(g):
+  of the rows with the same edges, only the first one is kept.
+
+  The rows are sorted by their words, in O(n log n) comparisons of rows.
+
+  @param[in,out] b Bit graph
+*/
+void remove_duplicate_species(BitGraph &b);
+
+
+/**
+  @brief Return true if \e b contains a red sigma-graph, as
+  has_red_sigmagraph(g).
+
+  Two active characters a and b induce a red sigma-graph if some species have
+  both, a only and b only. The rows of each active character are merged a
+  word at a time: their union tells the characters that share a species with
+  it, and their intersection the characters that all of its species have.
+
+  @param[in] b Bit graph
+
+  @return bool
+*/
+bool has_red_sigmagraph(const BitGraph &b);
+
+
+/**
+  @brief Build the bit graphs of the connected components of \e b, as
+  connected_components(g).
+
+  If \e b is connected, the vector has size 1 and the graph is empty.
+
+  @param[in] b Bit graph
+
+  @return Vector of unique pointers to each component
+*/
+BitGraphVector connected_components(const BitGraph &b);
+
+
+/**
+  @brief Realize the signed character \e sc in \e b, as
+  realize_character(sc, g).
+
+  @param[in]     sc SignedCharacter of \e b
+  @param[in,out] b  Bit graph
+
+  @return Realized characters (list of signed characters).
+          If the realization was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+std::pair<std::list<SignedCharacter>, bool> realize_character(const SignedCharacter &sc, BitGraph &b);
+
+
+/**
+  @brief Realize the list of characters \e lsc (+ or - each) in \e b, as
+  realize(lsc, g).
+
+  @param[in]     lsc List of signed characters of \e b
+  @param[in,out] b   Bit graph
+
+  @return Realized characters (list of signed characters).
+          If the realizations were successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+
+  @throws std::runtime_error if a character of \e lsc is not in \e b
+*/
+std::pair<std::list<SignedCharacter>, bool> realize(const std::list<SignedCharacter> &lsc, BitGraph &b);
+
+
+/**
+  @brief Realize the inactive characters of the species of row \e s in \e b,
+  as realize_species(v, g).
+
+  @param[in]     s Row of a species
+  @param[in,out] b Bit graph
+
+  @return Realized characters (list of signed characters).
+          If the realization was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+std::pair<std::list<SignedCharacter>, bool> realize_species(size_t s, BitGraph &b);
+
+
+/**
+  @brief Realize the characters in \e b that are red-universal or universal,
+  as realize_red_univ_and_univ_chars(g).
+
+  @param[in,out] b Bit graph
+
+  @return Realized characters (list of signed characters)
+*/
+std::pair<std::list<SignedCharacter>, bool> realize_red_univ_and_univ_chars(BitGraph &b);
+
+#endif  // BITGRAPH_HPP
@@ -0,0 +1,405 @@
+/**
+ *
+ * @file cache.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+  Signature of a vertex during the color refinement: its previous color and
+  the sorted list of (edge color, neighbor color) pairs
+*/
+typedef std::pair<size_t, std::vector<std::pair<int, size_t>>> Signature;
+
+/**
+  Adjacency lists of the rows or of the columns of a matrix: (edge color,
+  neighbor) pairs
+*/
+typedef std::vector<std::vector<std::pair<int, size_t>>> Adjacency;
+
+
+/**
+  @brief Replace the colors in \e colors with the rank of the signatures.
+
+  The ranks only depend on the signatures, not on the order of the vertices.
+
+  @param[in]  signatures Signature of each vertex
+  @param[out] colors     Color of each vertex
+
+  @return Number of distinct colors
+*/
+size_t rank_signatures(const std::vector<Signature> &signatures,
+                       std::vector<size_t> &colors) {
+    std::vector<size_t> index(signatures.size());
+    for (size_t i = 0; i < index.size(); ++i)
+        index[i] = i;
+
+    std::sort(index.begin(), index.end(), [&signatures](size_t a, size_t b) {
+        return signatures[a] < signatures[b];
+    });
+
+    size_t rank = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (i > 0 && signatures[index[i]] != signatures[index[i - 1]])
+            ++rank;
+        colors[index[i]] = rank;
+    }
+
+    return (index.empty() ? 0 : rank + 1);
+}
+
+
+/**
+  @brief Compute the canonical form \e cm of the matrix whose rows and columns
+  have the adjacency lists \e row_adj and \e col_adj .
+
+  @param[in]  row_adj (edge color, column) pairs of each row (1 black, 2 red)
+  @param[in]  col_adj (edge color, row) pairs of each column
+  @param[in]  names   Name of the character of each column
+  @param[out] cm      Canonical form
+*/
+void canonical_form(const Adjacency &row_adj, const Adjacency &col_adj,
+                    const std::vector<std::string> &names, CanonicalMatrix &cm) {
+    cm.rows.clear();
+    cm.characters.clear();
+
+    // color refinement, until the number of colors is stable
+    std::vector<size_t> row_color(row_adj.size(), 0), col_color(col_adj.size(), 0);
+    std::vector<Signature> row_sig(row_adj.size()), col_sig(col_adj.size());
+    size_t num_colors = 0;
+    while (true) {
+        check_deadline("canonical matrix");
+
+        for (size_t i = 0; i < row_adj.size(); ++i) {
+            row_sig[i].first = row_color[i];
+            row_sig[i].second.clear();
+            for (const auto &e : row_adj[i])
+                row_sig[i].second.emplace_back(e.first, col_color[e.second]);
+            std::sort(row_sig[i].second.begin(), row_sig[i].second.end());
+        }
+
+        for (size_t j = 0; j < col_adj.size(); ++j) {
+            col_sig[j].first = col_color[j];
+            col_sig[j].second.clear();
+            for (const auto &e : col_adj[j])
+                col_sig[j].second.emplace_back(e.first, row_color[e.second]);
+            std::sort(col_sig[j].second.begin(), col_sig[j].second.end());
+        }
+
+        const size_t new_num_colors = rank_signatures(row_sig, row_color) +
+                                      rank_signatures(col_sig, col_color);
+        if (new_num_colors == num_colors)
+            break;
+
+        num_colors = new_num_colors;
+    }
+
+    // sort the columns by color (ties keep the input order)
+    std::vector<size_t> col_order(names.size());
+    for (size_t j = 0; j < col_order.size(); ++j)
+        col_order[j] = j;
+    std::stable_sort(col_order.begin(), col_order.end(), [&col_color](size_t a, size_t b) {
+        return col_color[a] < col_color[b];
+    });
+
+    std::vector<size_t> col_position(names.size());
+    for (size_t j = 0; j < col_order.size(); ++j) {
+        col_position[col_order[j]] = j;
+        cm.characters.push_back(names[col_order[j]]);
+    }
+
+    // build the rows on the sorted columns, then sort them by color and content
+    std::vector<std::pair<size_t, std::string>> rows(row_adj.size());
+    for (size_t i = 0; i < row_adj.size(); ++i) {
+        rows[i].first = row_color[i];
+        rows[i].second.assign(names.size(), '0');
+        for (const auto &e : row_adj[i])
+            rows[i].second[col_position[e.second]] = (e.first == 1 ? '1' : '2');
+    }
+    std::sort(rows.begin(), rows.end());
+
+    for (auto &row : rows)
+        cm.rows.push_back(std::move(row.second));
+}
+
+
+/**
+  @brief Return the path of the cache entry \e key in \e directory .
+*/
+std::string entry_path(const std::string &directory, const std::string &key) {
+    return directory + "/" + key + ".ppp";
+}
+
+
+/**
+  Realized characters of a solved component, as canonical column indices
+*/
+typedef std::vector<std::pair<size_t, State>> MemoEntry;
+
+thread_local std::unordered_map<std::string, MemoEntry> memo_table;  ///< In-run memo table
+thread_local size_t memo_depth = 0;                                  ///< Number of open MemoScope
+
+std::atomic<size_t> num_stores{0};  ///< Calls of cache_store, numbering their temporary files
+
+
+/**
+  @brief Return the key of the component \e cm in the memo table.
+*/
+std::string memo_key(const std::string &solver, const CanonicalMatrix &cm) {
+    std::string key = solver + " " + std::to_string(cm.characters.size());
+    for (const auto &row : cm.rows)
+        key += " " + row;
+
+    return key;
+}
+
+}  // namespace
+
+
+void canonical_matrix(const RBGraph &g, CanonicalMatrix &cm) {
+    std::vector<std::string> names;
+    std::unordered_map<RBVertex, size_t> char_index;
+    for (RBVertex v : g.m_vertices) {
+        if (is_character(v, g)) {
+            char_index[v] = names.size();
+            names.push_back(g[v].name);
+        }
+    }
+
+    // adjacency of species and characters, with edge colors (1 black, 2 red)
+    Adjacency row_adj, col_adj(names.size());
+    for (RBVertex v : g.m_vertices) {
+        if (!is_species(v, g))
+            continue;
+
+        const size_t i = row_adj.size();
+        row_adj.emplace_back();
+
+        RBOutEdgeIter e, e_end;
+        std::tie(e, e_end) = out_edges(v, g);
+        for (; e != e_end; ++e) {
+            const int value = (g[*e].color == Color::black ? 1 : 2);
+            const size_t j = char_index.at(e->m_target);
+            row_adj[i].emplace_back(value, j);
+            col_adj[j].emplace_back(value, i);
+        }
+    }
+
+    canonical_form(row_adj, col_adj, names, cm);
+}
+
+
+void canonical_matrix(const BitGraph &b, CanonicalMatrix &cm) {
+    // the columns of the characters in b, numbered from 0
+    std::vector<std::string> names;
+    std::vector<size_t> col_index(b.character_names.size());
+    for (size_t j = 0; j < b.character_names.size(); ++j) {
+        if (b.has_character(j)) {
+            col_index[j] = names.size();
+            names.push_back(b.character_names[j]);
+        }
+    }
+
+    Adjacency row_adj(b.num_rows()), col_adj(names.size());
+    for (size_t i = 0; i < b.num_rows(); ++i) {
+        for (size_t j = 0; j < b.character_names.size(); ++j) {
+            if (!b.get(b.ones, i, j))
+                continue;
+
+            const int value = (b.get(b.red, i, j) ? 2 : 1);
+            row_adj[i].emplace_back(value, col_index[j]);
+            col_adj[col_index[j]].emplace_back(value, i);
+        }
+    }
+
+    canonical_form(row_adj, col_adj, names, cm);
+}
+
+
+std::string fingerprint(const CanonicalMatrix &cm, const std::string &solver) {
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto update = [&hash](const std::string &str) {
+        for (const unsigned char c : str) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= '\n';
+        hash *= 1099511628211ULL;
+    };
+
+    update(solver);
+    update(std::to_string(cm.rows.size()) + " " + std::to_string(cm.characters.size()));
+    for (const auto &row : cm.rows)
+        update(row);
+
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+
+    return buffer;
+}
+
+
+bool cache_lookup(const std::string &directory, const std::string &solver,
+                  const CanonicalMatrix &cm, bool &reduced,
+                  std::list<SignedCharacter> &realized) {
+    std::ifstream file(entry_path(directory, fingerprint(cm, solver)));
+    if (!file)
+        return false;
+
+    // header: solver, matrix size and canonical matrix
+    std::string entry_solver, row;
+    size_t rows, cols;
+    if (!(file >> entry_solver >> rows >> cols) || entry_solver != solver ||
+        rows != cm.rows.size() || cols != cm.characters.size())
+        return false;
+
+    for (size_t i = 0; i < rows; ++i) {
+        if (cols == 0)
+            row.clear();
+        else if (!(file >> row))
+            return false;
+
+        if (row != cm.rows[i])
+            // fingerprint collision
+            return false;
+    }
+
+    // result: feasibility and realized characters, as column indices
+    std::string result;
+    size_t length;
+    if (!(file >> result >> length) || (result != "ok" && result != "fail"))
+        return false;
+
+    std::list<SignedCharacter> entry_realized;
+    for (size_t i = 0; i < length; ++i) {
+        size_t column;
+        char sign;
+        if (!(file >> column >> sign) || column >= cols || (sign != '+' && sign != '-'))
+            return false;
+
+        entry_realized.push_back({
+                cm.characters[column],
+                (sign == '+' ? State::gain : State::lose)
+        });
+    }
+
+    reduced = (result == "ok");
+    realized = entry_realized;
+
+    if (logging::enabled) {
+        // verbosity enabled
+        std::cout << "[INFO] Cache hit: " << fingerprint(cm, solver) << std::endl;
+    }
+
+    return true;
+}
+
+
+void cache_store(const std::string &directory, const std::string &solver,
+                 const CanonicalMatrix &cm, const bool reduced,
+                 const std::list<SignedCharacter> &realized) {
+    std::unordered_map<std::string, size_t> column;
+    for (size_t j = 0; j < cm.characters.size(); ++j)
+        column[cm.characters[j]] = j;
+
+    std::ostringstream entry;
+    entry << solver << " " << cm.rows.size() << " " << cm.characters.size() << "\n";
+    for (const auto &row : cm.rows)
+        entry << row << "\n";
+
+    entry << (reduced ? "ok" : "fail") << " " << realized.size() << "\n";
+    for (const SignedCharacter &sc : realized) {
+        const auto c = column.find(sc.character);
+        if (c == column.end())
+            // not a character of the matrix, the result can not be mapped back
+            return;
+
+        entry << c->second << sc.state << " ";
+    }
+    entry << "\n";
+
+    // the cache directory may not exist yet, or may be created concurrently
+    mkdir(directory.c_str(), 0777);
+
+    const std::string path = entry_path(directory, fingerprint(cm, solver));
+    // the name of the temporary file is unique among processes, threads and
+    // calls, so concurrent writers of the same key never share it
+    std::ostringstream tmp_name;
+    tmp_name << path << "." << getpid() << "." << std::this_thread::get_id() << "."
+             << num_stores++ << ".tmp";
+    const std::string tmp_path = tmp_name.str();
+
+    std::ofstream file(tmp_path);
+    file << entry.str();
+    file.close();
+
+    if (!file || rename(tmp_path.c_str(), path.c_str()) != 0)
+        remove(tmp_path.c_str());
+}
+
+
+MemoScope::MemoScope() {
+    ++memo_depth;
+}
+
+
+MemoScope::~MemoScope() {
+    if (--memo_depth == 0)
+        memo_table.clear();
+}
+
+
+bool memo_lookup(const std::string &solver, const CanonicalMatrix &cm,
+                 std::list<SignedCharacter> &realized) {
+    const auto entry = memo_table.find(memo_key(solver, cm));
+    if (entry == memo_table.end())
+        return false;
+
+    realized.clear();
+    for (const auto &sc : entry->second)
+        realized.push_back({cm.characters[sc.first], sc.second});
+
+    if (logging::enabled) {
+        // verbosity enabled
+        std::cout << "[INFO] Memo hit on a component of " << cm.rows.size()
+                  << " species and " << cm.characters.size() << " characters" << std::endl;
+    }
+
+    return true;
+}
+
+
+void memo_store(const std::string &solver, const CanonicalMatrix &cm,
+                const std::list<SignedCharacter> &realized) {
+    std::unordered_map<std::string, size_t> column;
+    for (size_t j = 0; j < cm.characters.size(); ++j)
+        column[cm.characters[j]] = j;
+
+    MemoEntry entry;
+    for (const SignedCharacter &sc : realized) {
+        const auto c = column.find(sc.character);
+        if (c == column.end())
+            // not a character of the component, the result can not be mapped back
+            return;
+
+        entry.emplace_back(c->second, sc.state);
+    }
+
+    memo_table[memo_key(solver, cm)] = entry;
+}
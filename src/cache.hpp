@@ -0,0 +1,166 @@
+/**
+ *
+ * @file cache.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include "bitgraph.hpp"
+
+//=============================================================================
+// Data structures
+
+
+/**
+  @brief Struct used to represent the canonical form of a red-black graph
+
+  The canonical form is the matrix of the graph with its rows (species) and
+  columns (characters) sorted by the colors of a refinement of the graph that
+  does not depend on the order of species and characters, so that permuted
+  copies of the same matrix share the same canonical form.
+*/
+struct CanonicalMatrix {
+    std::vector<std::string> rows{};        ///< Rows of the matrix: '0' no edge, '1' black edge, '2' red edge
+    std::vector<std::string> characters{};  ///< Name of the character in each column
+};
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Compute the canonical form \e cm of \e g .
+
+  Species and characters are labeled by color refinement on the bipartite
+  graph (each vertex is colored by its previous color and by the multiset of
+  colors of its neighbors, split by edge color), until the coloring is stable.
+  Columns are then sorted by color, and rows by color and content.
+
+  Species or characters that the refinement cannot tell apart keep their
+  relative input order, so a few highly symmetric matrices may have more than
+  one canonical form: this only causes cache misses, never wrong results.
+
+  @param[in]  g  Red-black graph
+  @param[out] cm Canonical form of g
+
+  @throws TimeoutError if the deadline of the current thread passes
+*/
+void canonical_matrix(const RBGraph &g, CanonicalMatrix &cm);
+
+
+/**
+  @brief Compute the canonical form \e cm of the bit graph \e b, as
+  canonical_matrix(g, cm) on the red-black graph of \e b .
+
+  @param[in]  b  Bit graph
+  @param[out] cm Canonical form of b
+*/
+void canonical_matrix(const BitGraph &b, CanonicalMatrix &cm);
+
+
+/**
+  @brief Return the fingerprint of \e cm for the solver \e solver .
+
+  The fingerprint is a 64-bit FNV-1a hash of the solver name and of the
+  canonical matrix, written in hexadecimal.
+
+  @param[in] cm     Canonical form
+  @param[in] solver Solver name
+
+  @return Fingerprint
+*/
+std::string fingerprint(const CanonicalMatrix &cm, const std::string &solver);
+
+
+/**
+  @brief Look up the result of \e solver on the matrix \e cm in the cache
+  \e directory .
+
+  The entry is found by the fingerprint of \e cm, and it is used only if its
+  canonical matrix is equal to \e cm . The realized characters are mapped back
+  to the names of the characters in \e cm .
+
+  @param[in]  directory Cache directory
+  @param[in]  solver    Solver name
+  @param[in]  cm        Canonical form of the input graph
+  @param[out] reduced   True if the graph has been reduced
+  @param[out] realized  Realized characters
+
+  @return True if the result has been found
+*/
+bool cache_lookup(const std::string &directory, const std::string &solver,
+                  const CanonicalMatrix &cm, bool &reduced,
+                  std::list<SignedCharacter> &realized);
+
+
+/**
+  @brief Store the result of \e solver on the matrix \e cm in the cache
+  \e directory .
+
+  The canonical form must be computed before running the solver, which may
+  modify the input graph. The entry is written to a temporary file which is
+  then renamed, so that processes sharing the cache never read a partial
+  entry. Errors are ignored, the cache being only an optimization.
+
+  @param[in] directory Cache directory
+  @param[in] solver    Solver name
+  @param[in] cm        Canonical form of the input graph
+  @param[in] reduced   True if the graph has been reduced
+  @param[in] realized  Realized characters
+*/
+void cache_store(const std::string &directory, const std::string &solver,
+                 const CanonicalMatrix &cm, bool reduced,
+                 const std::list<SignedCharacter> &realized);
+
+
+/**
+  @brief Scope of the in-run memo table of the solved components.
+
+  The memo table is local to the thread, and it is cleared when the outermost
+  scope ends, so each run of a solver starts from an empty table.
+*/
+class MemoScope {
+public:
+    MemoScope();
+
+    ~MemoScope();
+
+    MemoScope(const MemoScope &) = delete;
+
+    MemoScope &operator=(const MemoScope &) = delete;
+};
+
+
+/**
+  @brief Look up the result of \e solver on the component \e cm in the memo
+  table of the current run.
+
+  The realized characters are mapped back to the names of the characters in
+  \e cm .
+
+  @param[in]  solver   Solver name
+  @param[in]  cm       Canonical form of the component
+  @param[out] realized Realized characters
+
+  @return True if the component has already been solved
+*/
+bool memo_lookup(const std::string &solver, const CanonicalMatrix &cm,
+                 std::list<SignedCharacter> &realized);
+
+
+/**
+  @brief Store the result of \e solver on the component \e cm in the memo
+  table of the current run.
+
+  @param[in] solver   Solver name
+  @param[in] cm       Canonical form of the component
+  @param[in] realized Realized characters
+*/
+void memo_store(const std::string &solver, const CanonicalMatrix &cm,
+                const std::list<SignedCharacter> &realized);
+
+#endif  // CACHE_HPP
@@ -0,0 +1,487 @@
+/**
+ *
+ * @file exponential.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "exponential.hpp"
+#include "bitgraph.hpp"
+#include "cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+/**
+  Number of levels of the search that are split in tasks
+*/
+const size_t split_depth = 3;
+
+
+/**
+  @brief Struct used to represent a state of the search on graphs of type
+  Graph (RBGraph or BitGraph)
+*/
+template <typename Graph>
+struct SearchNode {
+    std::unique_ptr<Graph> g{};               ///< Graph of the state
+    std::list<SignedCharacter> realized{};    ///< Characters realized to reach the state
+    size_t num_inactive{};                    ///< Inactive characters of the realized species
+    size_t depth{};                           ///< Number of species realized to reach the state
+};
+
+
+/**
+  @brief Struct used to represent the tasks of a thread
+*/
+template <typename Graph>
+struct WorkQueue {
+    std::mutex mutex{};                      ///< Lock of the queue
+    std::deque<SearchNode<Graph>> nodes{};   ///< Tasks: the owner pops the back, thieves the front
+};
+
+
+/**
+  @brief Return the key of the state \e g, equal for the graphs that are equal
+  up to a permutation of species and characters.
+*/
+template <typename Graph>
+std::string state_key(const Graph &g) {
+    CanonicalMatrix cm;
+    canonical_matrix(g, cm);
+
+    std::string key = std::to_string(cm.characters.size());
+    for (const auto &row : cm.rows)
+        key += " " + row;
+
+    return key;
+}
+
+
+/**
+  @brief Realize the red-universal and universal characters of \e g and remove
+  its duplicate species.
+
+  @param[in,out] g        Red-black graph
+  @param[in,out] realized Realized characters, extended with the new ones
+
+  @return False if \e g contains a red sigma-graph
+*/
+template <typename Graph>
+bool simplify(Graph &g, std::list<SignedCharacter> &realized) {
+    realized.splice(realized.end(), realize_red_univ_and_univ_chars(g).first);
+    remove_duplicate_species(g);
+
+    return !has_red_sigmagraph(g);
+}
+
+
+/**
+  @brief Return the species of \e g, in the order of its vertices.
+*/
+std::vector<RBVertex> species_of(const RBGraph &g) {
+    std::vector<RBVertex> species;
+    for (RBVertex v : g.m_vertices)
+        if (is_species(v, g))
+            species.push_back(v);
+
+    return species;
+}
+
+
+/**
+  @brief Return the rows of the species of \e b .
+*/
+std::vector<size_t> species_of(const BitGraph &b) {
+    std::vector<size_t> species(b.num_rows());
+    for (size_t i = 0; i < species.size(); ++i)
+        species[i] = i;
+
+    return species;
+}
+
+
+/**
+  @brief Return the number of inactive characters of the species \e v of \e g .
+*/
+size_t num_inactive_characters(const RBVertex v, const RBGraph &g) {
+    size_t num_inactive = 0;
+    for (RBVertex c : get_adj_vertices(v, g))
+        num_inactive += is_inactive(c, g);
+
+    return num_inactive;
+}
+
+
+/**
+  @brief Return the number of inactive characters of the species of row \e s
+  of \e b: its black edges.
+*/
+size_t num_inactive_characters(const size_t s, const BitGraph &b) {
+    size_t num_inactive = 0;
+    for (size_t k = 0; k < b.row_words(); ++k)
+        num_inactive += __builtin_popcountll(b.ones[s * b.row_words() + k] &
+                                             ~b.red[s * b.row_words() + k]);
+
+    return num_inactive;
+}
+
+
+/**
+  @brief Realize in \e copy, a copy of \e g, the species \e v of \e g .
+*/
+std::pair<std::list<SignedCharacter>, bool>
+realize_copy(const RBVertex v, const RBGraph &g, RBGraph &copy) {
+    return realize_species(get_vertex(g[v].name, copy), copy);
+}
+
+
+/**
+  @brief Realize in \e copy, a copy of \e b, the species of row \e s of \e b .
+*/
+std::pair<std::list<SignedCharacter>, bool>
+realize_copy(const size_t s, const BitGraph &, BitGraph &copy) {
+    return realize_species(s, copy);
+}
+
+
+/**
+  @brief Exact search over the realization orders of the species of a graph
+  of type Graph (RBGraph or BitGraph)
+*/
+template <typename Graph>
+class ExactSearch {
+public:
+    explicit ExactSearch(const size_t num_threads)
+            : queues(num_threads), deadline(get_deadline()), options(get_options()) {}
+
+    /**
+      @brief Search a successful reduction of \e g .
+
+      @param[in,out] g        Red-black graph
+      @param[out]    realized Realized characters
+
+      @return True if \e g has a successful reduction
+    */
+    bool run(Graph &g, std::list<SignedCharacter> &realized) {
+        if (!simplify(g, realized))
+            return false;
+
+        if (queues.size() <= 1)
+            return solve(g, realized);
+
+        SearchNode<Graph> root;
+        root.g = std::make_unique<Graph>();
+        copy_graph(g, *root.g);
+        push(0, std::move(root));
+
+        std::vector<std::thread> threads;
+        for (size_t id = 0; id < queues.size(); ++id)
+            threads.emplace_back(&ExactSearch::worker, this, id);
+        for (auto &thread : threads)
+            thread.join();
+
+        if (error)
+            std::rethrow_exception(error);
+
+        if (!stop)
+            return false;
+
+        realized.splice(realized.end(), solution);
+        return true;
+    }
+
+private:
+    std::vector<WorkQueue<Graph>> queues;   ///< Tasks of each thread
+    std::atomic<size_t> pending{0};         ///< Tasks pushed and not finished yet
+    std::atomic<bool> stop{false};          ///< True when the search is over
+    Deadline deadline;                      ///< Deadline of the thread running the search
+    GlobalOptions options;                  ///< Options of the thread running the search
+
+    std::mutex failed_mutex{};              ///< Lock of failed
+    std::unordered_set<std::string> failed{};  ///< Keys of the states known to fail
+
+    std::mutex solution_mutex{};            ///< Lock of solution and error
+    std::list<SignedCharacter> solution{};  ///< Characters realized by the first reduction found
+    std::exception_ptr error{};             ///< First exception thrown by a thread
+
+    /**
+      @brief Return true if the state \e key is known to fail.
+    */
+    bool is_failed(const std::string &key) {
+        std::lock_guard<std::mutex> lock(failed_mutex);
+        return (failed.count(key) > 0);
+    }
+
+    /**
+      @brief Record that the state \e key fails.
+    */
+    void set_failed(const std::string &key) {
+        std::lock_guard<std::mutex> lock(failed_mutex);
+        failed.insert(key);
+    }
+
+    /**
+      @brief Build the states reached from \e g by realizing one of its species.
+
+      The states that are not feasible, already known to fail or equal to a
+      previous state are pruned. The remaining states are sorted by the number
+      of inactive characters of the realized species.
+
+      @param[in]  g        Red-black graph
+      @param[out] branches States reached from g
+    */
+    void branch(const Graph &g, std::vector<SearchNode<Graph>> &branches) {
+        std::unordered_set<std::string> seen;
+
+        for (const auto v : species_of(g)) {
+            const size_t num_inactive = num_inactive_characters(v, g);
+
+            if (num_inactive == 0)
+                // realizing v would not change g
+                continue;
+
+            SearchNode<Graph> node;
+            node.g = std::make_unique<Graph>();
+            node.num_inactive = num_inactive;
+            copy_graph(g, *node.g);
+
+            bool feasible;
+            std::tie(node.realized, feasible) = realize_copy(v, g, *node.g);
+
+            if (!feasible || !simplify(*node.g, node.realized))
+                continue;
+
+            const std::string key = state_key(*node.g);
+            if (!seen.insert(key).second || is_failed(key))
+                continue;
+
+            branches.push_back(std::move(node));
+        }
+
+        std::stable_sort(branches.begin(), branches.end(),
+                         [](const SearchNode<Graph> &a, const SearchNode<Graph> &b) {
+                             return a.num_inactive < b.num_inactive;
+                         });
+    }
+
+    /**
+      @brief Search a successful reduction of \e g sequentially.
+
+      \e g has already been simplified.
+
+      @param[in,out] g        Red-black graph
+      @param[out]    realized Realized characters, extended with the new ones
+
+      @return True if \e g has a successful reduction
+    */
+    bool solve(Graph &g, std::list<SignedCharacter> &realized) {
+        if (stop)
+            return false;
+
+        check_deadline("exponential search");
+
+        if (is_empty(g))
+            return true;
+
+        const std::string key = state_key(g);
+        if (is_failed(key))
+            return false;
+
+        bool solved = false;
+        auto components = connected_components(g);
+
+        if (components.size() > 1) {
+            // the components are independent, and each one has to be reduced
+            std::list<SignedCharacter> lsc;
+            solved = true;
+            for (auto &component : components) {
+                if (!simplify(*component, lsc) || !solve(*component, lsc)) {
+                    solved = false;
+                    break;
+                }
+            }
+
+            if (solved)
+                realized.splice(realized.end(), lsc);
+        } else {
+            std::vector<SearchNode<Graph>> branches;
+            branch(g, branches);
+
+            for (auto &node : branches) {
+                if (solve(*node.g, node.realized)) {
+                    realized.splice(realized.end(), node.realized);
+                    solved = true;
+                    break;
+                }
+            }
+        }
+
+        if (!solved && !stop)
+            // a stopped search proves nothing about g
+            set_failed(key);
+
+        return solved;
+    }
+
+    /**
+      @brief Push the task \e node in the queue of the thread \e id .
+    */
+    void push(const size_t id, SearchNode<Graph> node) {
+        ++pending;
+
+        std::lock_guard<std::mutex> lock(queues[id].mutex);
+        queues[id].nodes.push_back(std::move(node));
+    }
+
+    /**
+      @brief Take a task for the thread \e id: the last one of its own queue,
+      or else the first one of the queue of another thread.
+
+      @return False if there are no tasks
+    */
+    bool take(const size_t id, SearchNode<Graph> &node) {
+        for (size_t i = 0; i < queues.size(); ++i) {
+            WorkQueue<Graph> &queue = queues[(id + i) % queues.size()];
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.nodes.empty())
+                continue;
+
+            if (i == 0) {
+                node = std::move(queue.nodes.back());
+                queue.nodes.pop_back();
+            } else {
+                node = std::move(queue.nodes.front());
+                queue.nodes.pop_front();
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+      @brief Record the characters realized by a successful reduction, and
+      stop the search.
+    */
+    void found(std::list<SignedCharacter> &realized) {
+        std::lock_guard<std::mutex> lock(solution_mutex);
+        if (stop)
+            return;
+
+        solution.splice(solution.end(), realized);
+        stop = true;
+    }
+
+    /**
+      @brief Run the tasks of the thread \e id until the search is over.
+    */
+    void worker(const size_t id) {
+        DeadlineScope deadline_scope(deadline);
+        OptionsScope options_scope(options);
+
+        while (!stop && pending > 0) {
+            SearchNode<Graph> node;
+            if (!take(id, node)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            try {
+                expand(id, node);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(solution_mutex);
+                if (!error)
+                    error = std::current_exception();
+                stop = true;
+            }
+
+            --pending;
+        }
+    }
+
+    /**
+      @brief Run the task \e node of the thread \e id: split it in new tasks,
+      or search it sequentially if it is deep enough.
+    */
+    void expand(const size_t id, SearchNode<Graph> &node) {
+        check_deadline("exponential search");
+
+        if (node.depth >= split_depth) {
+            if (solve(*node.g, node.realized))
+                found(node.realized);
+
+            return;
+        }
+
+        if (is_empty(*node.g)) {
+            found(node.realized);
+            return;
+        }
+
+        if (connected_components(*node.g).size() > 1) {
+            // components are solved together, by a single task
+            if (solve(*node.g, node.realized))
+                found(node.realized);
+
+            return;
+        }
+
+        std::vector<SearchNode<Graph>> branches;
+        branch(*node.g, branches);
+
+        // pushed in reverse order, so the owner pops the best branch first
+        for (auto it = branches.rbegin(); it != branches.rend(); ++it) {
+            std::list<SignedCharacter> realized = node.realized;
+            realized.splice(realized.end(), it->realized);
+            it->realized = std::move(realized);
+            it->depth = node.depth + 1;
+
+            push(id, std::move(*it));
+        }
+    }
+};
+
+}  // namespace
+
+
+std::list<SignedCharacter> ppp_exponential(RBGraph &g) {
+    size_t num_threads = exponential::threads;
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (logging::enabled) {
+        // verbosity enabled
+        std::cout << "[INFO] Running the exponential algorithm with " << num_threads
+                  << " threads" << (bitgraph::enabled ? " on bit graphs" : "") << std::endl;
+    }
+
+    std::list<SignedCharacter> realized;
+    bool solved;
+
+    if (bitgraph::enabled) {
+        BitGraph b;
+        build_bitgraph(g, b);
+        solved = ExactSearch<BitGraph>(num_threads).run(b, realized);
+    } else {
+        solved = ExactSearch<RBGraph>(num_threads).run(g, realized);
+    }
+
+    if (!solved) {
+        throw std::runtime_error(
+                "[ERROR] In ppp_exponential(): the graph has no successful reduction");
+    }
+
+    clear(g);
+
+    return realized;
+}
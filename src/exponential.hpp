@@ -0,0 +1,52 @@
+/**
+ *
+ * @file exponential.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef EXPONENTIAL_HPP
+#define EXPONENTIAL_HPP
+
+#include "functions.hpp"
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Compute a successful reduction of \e g by an exact search over the
+  realization orders of its species.
+
+  Each step of the search realizes a species with realize_species, then the
+  red-universal and universal characters and the duplicate species; a state
+  is discarded if the realization is not feasible or if it contains a red
+  sigma-graph. The search is pruned by:
+  - component independence: the connected components of a state are solved
+    one after the other, and the state fails as soon as one of them fails;
+  - dominance: the species whose realization leads to the same state (up to a
+    permutation of species and characters) as another species are explored
+    once, and the states already known to fail are skipped.
+
+  The first levels of the search are split in tasks, which are run by
+  exponential::threads threads stealing each other's tasks when they run out
+  of work; the deeper levels are searched sequentially by each task. The
+  search takes O(m! poly(n, m)) time in the worst case, on a graph with n
+  species and m inactive characters.
+
+  If bitgraph::enabled, the states of the search are bit graphs (see
+  BitGraph) built from \e g, instead of copies of \e g .
+
+  On success, \e g is cleared.
+
+  @param[in,out] g Red-black graph
+
+  @return Realized characters (list of signed characters)
+
+  @throws std::runtime_error if \e g has no successful reduction
+  @throws TimeoutError if the deadline of the current thread passes
+*/
+std::list<SignedCharacter> ppp_exponential(RBGraph &g);
+
+#endif  // EXPONENTIAL_HPP
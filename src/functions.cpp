@@ -8,8 +8,90 @@
 
 #include "functions.hpp"
 #include "rbgraph.hpp"
+#include "cache.hpp"
+#include "exponential.hpp"
+#include <boost/algorithm/string.hpp>
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/depth_first_search.hpp>
+#include <unordered_set>
+
+namespace {
+
+thread_local Deadline deadline = Deadline::max();  ///< Deadline of the current thread
+
+}  // namespace
+
+DeadlineScope::DeadlineScope(const Deadline &d) : previous(deadline) {
+    deadline = d;
+}
+
+DeadlineScope::~DeadlineScope() {
+    deadline = previous;
+}
+
+Deadline get_deadline() {
+    return deadline;
+}
+
+void check_deadline(const std::string &phase) {
+    if (deadline != Deadline::max() && std::chrono::steady_clock::now() >= deadline)
+        throw TimeoutError(phase);
+}
+
+const RBGraph &DerivedGraphs::minimal_form() {
+    if (min_version != version(g)) {
+        if (logging::enabled) {
+            std::cout << "[INFO] Computing minimal form" << std::endl;
+        }
+
+        minimal_form_graph(g, g_min);
+        min_version = version(g);
+    }
+
+    return g_min;
+}
+
+
+const RBGraph &DerivedGraphs::skeleton() {
+    if (skeleton_version != version(g)) {
+        if (logging::enabled) {
+            std::cout << "[INFO] Computing g-skeleton" << std::endl;
+        }
+
+        g_skeleton(g, gm);
+        skeleton_version = version(g);
+    }
+
+    return gm;
+}
+
+
+const RBGraph &DerivedGraphs::maximal_reducible() {
+    if (max_version != version(g)) {
+        if (logging::enabled) {
+            std::cout << "[INFO] Computing max_red_graph" << std::endl;
+        }
+
+        maximal_reducible_graph(minimal_form(), g_max, true);
+        max_version = version(g);
+    }
+
+    return g_max;
+}
+
+
+std::list<RBVertex> &DerivedGraphs::sources() {
+    if (sources_version != version(g)) {
+        if (logging::enabled) {
+            std::cout << "[INFO] Getting Sources" << std::endl;
+        }
+
+        gm_sources = get_sources(skeleton());
+        sources_version = version(g);
+    }
+
+    return gm_sources;
+}
 
 std::pair<std::list<SignedCharacter>, bool>
 realize_character(const SignedCharacter &sc, RBGraph &g) {
@@ -49,6 +131,10 @@ realize_character(const SignedCharacter &sc, RBGraph &g) {
         // realize the character c+:
         // - add a red edge between c and each species in D(c) \ N(c)
         // - delete all black edges incident on c
+        if (MaximalCharacterIndex *index = get_maximal_index(g))
+            index->remove_character(cv);
+        bump_version(g);
+
         std::tie(v, v_end) = vertices(g);
         for (; v != v_end; ++v) {
             if (!is_species(*v, g) || c_map.at(*v) != c_map.at(cv)) {
@@ -145,6 +231,53 @@ std::pair<std::list<SignedCharacter>, bool> realize_species(const RBVertex v,
     return realize(lsc, g);
 }
 
+/**
+  @brief Return the species in the connected component of the character \e c
+  of \e g, in the order of the vertices of \e g .
+
+  @param[in] c     Character
+  @param[in] g     Red-black graph
+  @param[in] index Component index of an earlier version of \e g, whose
+                   components can only have been split since
+  @param[in] dirty Components of \e index changed since, visited again from c
+
+  @return Species
+*/
+static std::vector<RBVertex>
+component_species(const RBVertex c, const RBGraph &g, const ComponentIndex &index,
+                  const std::set<size_t> &dirty) {
+    const size_t id = index.component_id(c);
+    const bool changed = (dirty.count(id) > 0);
+
+    // visit the current component of c, if it may have been split
+    std::unordered_set<RBVertex> reached;
+    if (changed) {
+        std::vector<RBVertex> stack{c};
+        reached.insert(c);
+
+        while (!stack.empty()) {
+            const RBVertex v = stack.back();
+            stack.pop_back();
+
+            RBOutEdgeIter e, e_end;
+            std::tie(e, e_end) = out_edges(v, g);
+            for (; e != e_end; ++e) {
+                if (reached.insert(e->m_target).second)
+                    stack.push_back(e->m_target);
+            }
+        }
+    }
+
+    std::vector<RBVertex> species;
+    ComponentIndex::VertexIter v, v_end;
+    std::tie(v, v_end) = index.component(id);
+    for (; v != v_end; ++v)
+        if (is_species(*v, g) && (!changed || reached.count(*v) > 0))
+            species.push_back(*v);
+
+    return species;
+}
+
 std::pair<std::list<SignedCharacter>, bool>
 realize(const std::list<SignedCharacter> &lsc, RBGraph &g) {
     std::list<SignedCharacter> output;
@@ -152,24 +285,123 @@ realize(const std::list<SignedCharacter> &lsc, RBGraph &g) {
     // realize the list of signed characters lsc; the algorithm stops when a
     // non-feasible realization is encountered, setting the boolean flag to false
     // TODO: maybe change this behaviour
-    for (const SignedCharacter i : lsc) {
+
+    // the components are labelled once: a realization can only split the
+    // component of its character, which is visited again when it is needed
+    const ComponentIndex &index = component_index(g);
+    std::set<size_t> dirty;
+
+    // the edges and vertices are removed with the boost functions, telling the
+    // maximal index and the worklists here: remove_edge and remove_vertex check
+    // that the vertices exist by scanning all the vertices of g
+    MaximalCharacterIndex *maximal = get_maximal_index(g);
+    Worklists *worklists = get_worklists(g);
+
+    // vertices that may have been left with no edges
+    std::vector<RBVertex> touched;
+
+    bool feasible = true, missing = false;
+    for (const SignedCharacter &i : lsc) {
         if (std::find(output.cbegin(), output.cend(), i) != output.cend()) {
             // the signed character i has already been realized in a previous sc
             continue;
         }
 
-        std::list<SignedCharacter> sc;
-        bool feasible;
+        // a vertex left with no edges by a realization counts as deleted
+        missing = (!exists(i.character, g) ||
+                   (!output.empty() && out_degree(get_vertex(i.character, g), g) == 0));
+        if (missing)
+            break;
 
-        std::tie(sc, feasible) = realize_character(i, g);
+        const RBVertex cv = get_vertex(i.character, g);
 
-        if (!feasible) {
-            return std::make_pair(sc, false);
+        const std::vector<RBVertex> species = component_species(cv, g, index, dirty);
+
+        if (i.state == State::gain && is_inactive(cv, g)) {
+            // realize the character c+ (see realize_character)
+            if (maximal)
+                maximal->remove_character(cv);
+            bump_version(g);
+
+            for (RBVertex v : species) {
+                RBEdge e;
+                bool exists;
+                std::tie(e, exists) = edge(v, cv, g);
+
+                if (exists) {
+                    if (maximal)
+                        maximal->remove_edge(v, cv);
+                    if (worklists) {
+                        worklists->touch(v);
+                        worklists->touch(cv);
+                    }
+
+                    boost::remove_edge(e, g);
+                    touched.push_back(v);
+                } else {
+                    add_edge(v, cv, Color::red, g);
+                }
+            }
+        } else if (i.state == State::lose && is_active(cv, g) &&
+                   species.size() == out_degree(cv, g)) {
+            // realize the character c-, connected to all the species of its
+            // component (see realize_character)
+            for (RBVertex v : get_adj_vertices(cv, g))
+                touched.push_back(v);
+
+            clear_vertex(cv, g);
+        } else {
+            feasible = false;
+            break;
         }
 
-        output.splice(output.cend(), sc);
+        touched.push_back(cv);
+        dirty.insert(index.component_id(cv));
+        output.push_back(i);
     }
 
+    if (!output.empty()) {
+        // delete all isolated vertices: the ones left with no edges by the
+        // realizations, and the components of a single vertex
+        for (size_t c = 0; c < index.num_components(); ++c) {
+            ComponentIndex::VertexIter v, v_end;
+            std::tie(v, v_end) = index.component(c);
+            if (v_end - v == 1)
+                touched.push_back(*v);
+        }
+
+        std::unordered_set<RBVertex> removed;
+        for (RBVertex v : touched) {
+            if (!removed.insert(v).second || out_degree(v, g) != 0)
+                continue;
+
+            const bool species = is_species(v, g);
+            if (maximal) {
+                if (species)
+                    maximal->remove_species(v);
+                else
+                    maximal->remove_character(v);
+            }
+            if (worklists)
+                worklists->remove_vertex(v);
+
+            vertex_map(g).erase(g[v].name);
+            boost::remove_vertex(v, g);
+
+            if (species)
+                num_species(g)--;
+            else
+                num_characters(g)--;
+        }
+        bump_version(g);
+    }
+
+    if (missing)
+        throw std::runtime_error("[ERROR] In realize(): vertex does not exist");
+
+    if (!feasible)
+        return std::make_pair(std::list<SignedCharacter>(), false);
+
     return std::make_pair(output, true);
 }
 
@@ -218,45 +450,35 @@ std::list<RBVertex> get_all_minimal_p_active_species(const RBGraph &g,
                                                      bool all) {
     std::list<RBVertex> out;
     std::list<RBVertex> active_species = get_active_species(g);
+    if (active_species.empty())
+        return out;
+
     sort_by_degree(active_species, g);
 
+    // the Hasse diagram of the worklists of g, or else one built for this call
+    std::unique_ptr<SpeciesHasse> local_hasse;
+    Worklists *worklists = get_worklists(g);
+    if (worklists == nullptr)
+        local_hasse = std::make_unique<SpeciesHasse>(g);
+    SpeciesHasse &hasse = (worklists ? worklists->hasse() : *local_hasse);
+
     bool found;
-    int num_inctv_chars_v, num_inctv_chars_u;
     for (RBVertex v : active_species) {
+        check_deadline("p-active species search");
+
         found = false;
-        // for every active species v in the sorted list of active species
-        for (int i = 1; i < num_characters(g); ++i) {
-            // index "i" is used after to check if vertex "u" has "i" more inactive characters than "v"
+        // for every active species v in the sorted list of active species, and
+        // every species u including v, from the ones with fewer inactive characters
+        for (RBVertex u : hasse.supersets(v)) {
+            // check if the realization of v and then of u can generate any red-sigmagraphs in g
+            RBGraph g_copy;
+            copy_graph(g, g_copy);
 
-            for (RBVertex u : get_neighbors(v, g)) {
-                if (u == v || is_character(u, g)) {
-                    continue;
-                }
-                // for every species u (neighbor of v)
-
-                if (includes_species(u, v, g)) {
-                    // if u includes all the inactive species of v, then check if u has "i" species more than v
-                    num_inctv_chars_v =
-                        get_adj_inactive_characters(v, g).size();
-                    num_inctv_chars_u =
-                        get_adj_inactive_characters(u, g).size();
-                    if (num_inctv_chars_u == num_inctv_chars_v + i) {
-
-                        // check if the realization of v and then of u can generate any red-sigmagraphs in g
-                        RBGraph g_copy;
-                        copy_graph(g, g_copy);
-
-                        realize_species(get_vertex(g[v].name, g_copy), g_copy);
-                        realize_species(get_vertex(g[u].name, g_copy), g_copy);
-                        if (!has_red_sigmagraph(g_copy)) {
-                            out.push_back(v);
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-            }
-            if (found) {
+            realize_species(get_vertex(g[v].name, g_copy), g_copy);
+            realize_species(get_vertex(g[u].name, g_copy), g_copy);
+            if (!has_red_sigmagraph(g_copy)) {
+                out.push_back(v);
+                found = true;
                 break;
             }
         }
@@ -268,11 +490,19 @@ std::list<RBVertex> get_all_minimal_p_active_species(const RBGraph &g,
 }
 
 RBVertex get_minimal_p_active_species(const RBGraph &g) {
-    return *get_all_minimal_p_active_species(g, false).begin();
+    const std::list<RBVertex> species = get_all_minimal_p_active_species(g, false);
+    return (species.empty() ? nullptr : species.front());
 }
 
 RBVertex get_quasi_active_species(const RBGraph &g) {
-    for (RBVertex v : g.m_vertices) {
+    // only the species with black and red edges are checked, which are listed
+    // by the worklists of g if it has any
+    Worklists *worklists = get_worklists(g);
+    const std::list<RBVertex> candidates =
+            (worklists != nullptr ? worklists->list(Worklist::mixed_species)
+                                  : std::list<RBVertex>(g.m_vertices.begin(), g.m_vertices.end()));
+
+    for (RBVertex v : candidates) {
         if (!is_species(v, g)) {
             continue;
         }
@@ -300,116 +530,324 @@ RBVertex get_quasi_active_species(const RBGraph &g) {
     return nullptr;
 }
 
+/**
+  @brief Solve the connected component \e g with \e solve, reusing the result
+  of an identical component already solved in the current run.
+
+  @param[in] g      Connected component
+  @param[in] solver Solver name
+  @param[in] solve  Solver
+
+  @return Realized characters
+*/
+static std::list<SignedCharacter>
+solve_component(RBGraph &g, const std::string &solver,
+                std::list<SignedCharacter> (*solve)(RBGraph &)) {
+    check_deadline("connected components");
+
+    if (!memo::enabled)
+        return solve(g);
+
+    // the canonical form is computed before solve(), which modifies g
+    CanonicalMatrix cm;
+    canonical_matrix(g, cm);
+
+    std::list<SignedCharacter> realized;
+    if (memo_lookup(solver, cm, realized))
+        return realized;
+
+    realized = solve(g);
+    memo_store(solver, cm, realized);
+
+    return realized;
+}
+
+namespace {
+
+thread_local std::map<std::string, RuleCounters> counters;  ///< Counters of the rules of the current thread
+
+}  // namespace
+
+void RuleEngine::add_rule(const std::string &name, Test test, Action action) {
+    order.push_back(rules.size());
+    rules.push_back({name, std::move(test), std::move(action)});
+}
+
+void RuleEngine::set_order(const std::string &names) {
+    std::vector<std::string> list;
+    boost::split(list, names, boost::is_any_of(","));
+
+    order.clear();
+    for (const std::string &name : list) {
+        const auto rule = std::find_if(rules.cbegin(), rules.cend(),
+                                       [&name](const Rule &r) { return r.name == name; });
+        if (rule == rules.cend()) {
+            throw std::runtime_error(
+                    "[ERROR] In RuleEngine::set_order(): unknown rule \"" + name + "\"");
+        }
+
+        order.push_back(rule - rules.cbegin());
+    }
+}
+
+bool RuleEngine::uses(const std::string &name) const {
+    return std::any_of(order.cbegin(), order.cend(),
+                       [this, &name](const size_t i) { return rules[i].name == name; });
+}
+
+bool RuleEngine::step(RBGraph &g, std::list<SignedCharacter> &realized) {
+    for (const size_t i : order) {
+        const Rule &rule = rules[i];
+        RuleCounters &rule_counters = counters[rule.name];
+        const auto start = std::chrono::steady_clock::now();
+
+        check_deadline(rule.name);
+
+        RBVertex witness = nullptr;
+        ++rule_counters.evaluations;
+        const bool matched = rule.test(g, witness);
+
+        if (matched) {
+            ++rule_counters.hits;
+            realized.splice(realized.end(), rule.action(g, witness));
+        }
+
+        rule_counters.cost += std::chrono::steady_clock::now() - start;
+
+        if (matched)
+            return true;
+    }
+
+    return false;
+}
+
+const std::map<std::string, RuleCounters> &rule_counters() {
+    return counters;
+}
+
+void reset_rule_counters() {
+    counters.clear();
+}
+
+void add_rule_counters(const std::map<std::string, RuleCounters> &other) {
+    for (const auto &rule : other) {
+        RuleCounters &rule_counters = counters[rule.first];
+        rule_counters.evaluations += rule.second.evaluations;
+        rule_counters.hits += rule.second.hits;
+        rule_counters.cost += rule.second.cost;
+    }
+}
+
+RuleEngine reduction_rules() {
+    RuleEngine engine;
+    engine.add_rule(
+            "pending",
+            [](const RBGraph &g, RBVertex &witness) {
+                const std::list<RBVertex> pending_species = get_pending_species(g);
+                if (pending_species.size() != 1)
+                    return false;
+
+                witness = pending_species.front();
+                return true;
+            },
+            [](RBGraph &g, RBVertex witness) { return realize_species(witness, g).first; });
+    engine.add_rule(
+            "p-active",
+            [](const RBGraph &g, RBVertex &witness) {
+                witness = get_minimal_p_active_species(g);
+                return (witness != nullptr);
+            },
+            [](RBGraph &g, RBVertex witness) { return realize_species(witness, g).first; });
+    engine.add_rule(
+            "degenerate",
+            [](const RBGraph &g, RBVertex &) { return is_degenerate(g); },
+            [](RBGraph &g, RBVertex) {
+                std::list<SignedCharacter> lsc;
+                for (RBVertex c : get_inactive_chars(g)) {
+                    lsc.splice(
+                        lsc.end(),
+                        realize_character({g[c].name, State::gain}, g).first);
+                }
+                return lsc;
+            });
+    engine.add_rule(
+            "active",
+            [](const RBGraph &g, RBVertex &witness) {
+                const std::list<RBVertex> active_species = get_active_species(g);
+                if (active_species.size() != 1)
+                    return false;
+
+                witness = active_species.front();
+                return true;
+            },
+            [](RBGraph &g, RBVertex witness) { return realize_species(witness, g).first; });
+    engine.add_rule(
+            "quasi-active",
+            [](const RBGraph &g, RBVertex &witness) {
+                // the cheaper condition is tested first
+                if (!all_species_with_red_edges(g))
+                    return false;
+
+                witness = get_quasi_active_species(g);
+                return (witness != nullptr);
+            },
+            [](RBGraph &g, RBVertex witness) { return realize_species(witness, g).first; });
+    engine.add_rule(
+            "exponential",
+            [](const RBGraph &, RBVertex &) { return exponential::enabled; },
+            [](RBGraph &g, RBVertex) { return ppp_exponential(g); });
+
+    return engine;
+}
+
 std::list<SignedCharacter> ppp_maximal_reducible_graphs(RBGraph &g) {
+    MemoScope memo_scope;
+    WorklistScope worklist_scope(g);
+
+    RuleEngine engine = reduction_rules();
+    if (!rules::order.empty())
+        engine.set_order(rules::order);
+
+    // the graph as given, on which the exponential search restarts if the
+    // rules lead to a graph with no reduction
+    const bool restart = exponential::enabled && engine.uses("exponential");
+    RBGraph g_input;
+    if (restart)
+        copy_graph(g, g_input);
 
     std::list<SignedCharacter> realized_chars =
         realize_red_univ_and_univ_chars(g).first;
-    remove_duplicate_species(g);
     std::list<SignedCharacter> tmp;
 
-    while (!is_empty(g)) {
-        std::cout << "PRINT G " << std::endl << g << std::endl;
-        if (get_pending_species(g).size() == 1) {
-            tmp = realize_species(*get_pending_species(g).begin(), g).first;
-        } else if (get_minimal_p_active_species(g) != 0) {
-            tmp = realize_species(get_minimal_p_active_species(g), g).first;
-        } else if (is_degenerate(g)) {
-            for (RBVertex c : get_inactive_chars(g)) {
-                tmp.splice(
-                    tmp.end(),
-                    realize_character({g[c].name, State::gain}, g).first);
-            }
-        } else if (get_active_species(g).size() == 1) {
-            tmp = realize_species(*get_active_species(g).begin(), g).first;
-        } else if (get_quasi_active_species(g) != 0
-                   && all_species_with_red_edges(g)) {
-            tmp = realize_species(get_quasi_active_species(g), g).first;
-        } else {
-            if (has_red_sigmagraph(g)) {
-                std::cout << "[INFO] Red sigma graph generated" << std::endl;
-            }
-            throw std::runtime_error(
-                "[ERROR] In ppp_maximal_reducible_graphs(): could not build "
-                "the PPP");
-        }
-
-        realized_chars.splice(realized_chars.end(), tmp);
-        realized_chars.splice(realized_chars.end(),
-                              realize_red_univ_and_univ_chars(g).first);
+    try {
         remove_duplicate_species(g);
 
-        if (!is_empty(g)) {
-            RBGraphVector conn_compnts = connected_components(g);
-            auto cc = conn_compnts.begin();
-            auto cc_end = conn_compnts.end();
-            for (; cc != cc_end; ++cc) {
-                RBGraph tmp_graph;
-                copy_graph(*cc->get(), tmp_graph);
-                tmp = ppp_maximal_reducible_graphs(*cc->get());
-                if (logging::enabled) {
-                    std::cout << "[INFO] iterating in conn_compt " << std::endl;
+        while (!is_empty(g)) {
+            check_deadline("ppp_maximal_reducible_graphs");
+
+            std::cout << "PRINT G " << std::endl << g << std::endl;
+            if (!engine.step(g, tmp)) {
+                if (has_red_sigmagraph(g)) {
+                    std::cout << "[INFO] Red sigma graph generated" << std::endl;
                 }
-                for (RBVertex v : tmp_graph.m_vertices) {
-                    remove_vertex(tmp_graph[v].name, g);
+                throw std::runtime_error(
+                    "[ERROR] In ppp_maximal_reducible_graphs(): could not build "
+                    "the PPP");
+            }
+
+            realized_chars.splice(realized_chars.end(), tmp);
+            realized_chars.splice(realized_chars.end(),
+                                  realize_red_univ_and_univ_chars(g).first);
+            remove_duplicate_species(g);
+
+            if (!is_empty(g)) {
+                RBGraphVector conn_compnts = connected_components(g);
+                auto cc = conn_compnts.begin();
+                auto cc_end = conn_compnts.end();
+                for (; cc != cc_end; ++cc) {
+                    RBGraph tmp_graph;
+                    copy_graph(*cc->get(), tmp_graph);
+                    tmp = solve_component(*cc->get(), "ppp", ppp_maximal_reducible_graphs);
+                    if (logging::enabled) {
+                        std::cout << "[INFO] iterating in conn_compt " << std::endl;
+                    }
+                    for (RBVertex v : tmp_graph.m_vertices) {
+                        remove_vertex(tmp_graph[v].name, g);
+                    }
+                    realized_chars.splice(realized_chars.end(), tmp);
                 }
-                realized_chars.splice(realized_chars.end(), tmp);
             }
         }
+    } catch (TimeoutError &e) {
+        // the characters realized so far are part of the partial result
+        e.prepend(realized_chars);
+        throw;
+    } catch (const std::runtime_error &) {
+        if (!restart)
+            throw;
+
+        realized_chars = ppp_exponential(g_input);
+        clear(g);
     }
     return realized_chars;
 }
 
-std::pair<std::list<SignedCharacter>, bool>
-realize_red_univ_and_univ_chars(RBGraph &g) {
+std::list<SignedCharacter> universal_characters(const RBGraph &g) {
+    const ComponentIndex &index = component_index(g);
+
+    // number of species in each connected component
+    std::vector<size_t> comp_species(index.num_components(), 0);
+    for (RBVertex v : g.m_vertices)
+        if (is_species(v, g))
+            ++comp_species[index.component_id(v)];
+
     std::list<SignedCharacter> output;
+    for (RBVertex v : g.m_vertices) {
+        if (!is_character(v, g))
+            continue;
 
-    RBVertexIter v, v_end, next;
-    std::tie(v, v_end) = vertices(g);
+        size_t degree = 0, black_degree = 0;
+        RBOutEdgeIter e, e_end;
+        std::tie(e, e_end) = out_edges(v, g);
+        for (; e != e_end; ++e) {
+            ++degree;
+            black_degree += is_black(*e, g);
+        }
 
-    std::list<SignedCharacter> lsc;
-    for (next = v; v != v_end; v = next) {
-        next++;
-        if (is_red_universal(*v, g)) {
-            // if v is red_universal
-            // realize v-
-            if (logging::enabled) {
-                // verbosity enabled
-                //std::cout << "G red-universal character " << g[*v].name << std::endl;
-            }
-            std::tie(lsc, std::ignore) =
-                realize_character({g[*v].name, State::lose}, g);
+        if (degree != comp_species[index.component_id(v)])
+            continue;
+        // v is connected to all the species of its component
+
+        if (black_degree > 0)
+            // v is universal
+            output.push_back({g[v].name, State::gain});
+        else
+            // v is red-universal
+            output.push_back({g[v].name, State::lose});
+    }
 
-            output.splice(output.cend(), lsc);
+    return output;
+}
 
-            // we have to loop again from the beginning, because if some isolate node has been deleted, the for loop is compromised
-            std::tie(v, v_end) = vertices(g);
-            next = v;
-        } else if (is_universal(*v, g)) {
-            // if v is universal
-            // realize v+
-            if (logging::enabled) {
-                // verbosity enabled
-                //std::cout << "G universal character " << g[*v].name << std::endl;
-            }
+std::pair<std::list<SignedCharacter>, bool>
+realize_red_univ_and_univ_chars(RBGraph &g) {
+    std::list<SignedCharacter> output;
 
-            std::list<SignedCharacter> lsc;
+    // realizing a character keeps the other red-universal and universal
+    // characters as they are, so they are realized as a batch; the batch can
+    // split a component, making new ones that are found by the next batch
+    std::list<SignedCharacter> lsc = universal_characters(g);
+    while (!lsc.empty()) {
+        // the characters with no edges are deleted with the isolated vertices,
+        // and only the first one is realized if it comes before the others
+        for (auto sc = std::next(lsc.begin()); sc != lsc.end();) {
+            if (out_degree(get_vertex(sc->character, g), g) == 0)
+                sc = lsc.erase(sc);
+            else
+                ++sc;
+        }
 
-            std::tie(lsc, std::ignore) =
-                realize_character({g[*v].name, State::gain}, g);
+        for (const SignedCharacter &sc : lsc) {
+            const RBVertex cv = get_vertex(sc.character, g);
 
-            output.splice(output.cend(), lsc);
+            // cv is connected to all the species of its component, so
+            // realizing c+ or c- deletes all its edges
+            if (sc.state == State::gain) {
+                if (MaximalCharacterIndex *index = get_maximal_index(g))
+                    index->remove_character(cv);
+            }
 
-            // we have to loop again from the beginning, because if some isolate node has been deleted, the for loop is compromised
-            std::tie(v, v_end) = vertices(g);
-            next = v;
+            clear_vertex(cv, g);
         }
-    }
 
-    if (!output.empty()) {
-        return std::make_pair(output, true);
-    } else {
-        return std::make_pair(output, false);
+        // delete all isolated vertices
+        remove_singletons(g);
+
+        output.splice(output.cend(), lsc);
+        lsc = universal_characters(g);
     }
+
+    return std::make_pair(output, !output.empty());
 }
 
 RBVertex get_extension(const RBVertex &s, const RBGraph &gmax,
@@ -494,32 +932,32 @@ RBVertex get_extension(const RBVertex &s, const RBGraph &gmax,
     for (RBVertex candidate : candidates) {
 
         // this list will contain the minimal characters that overlap with the ones
-        // of s. We are going to build it by first inserting all the vertices of gmin
-        // and then reducing it progressively.
-        std::set<RBVertex> overlapping_min_chars(gmin.m_vertices.begin(),
-                                                 gmin.m_vertices.end());
+        // of s. We are going to build it by first inserting all the characters of
+        // gmin, in the order of gmin, and then reducing it progressively.
+        std::list<RBVertex> overlapping_min_chars;
         for (RBVertex u : gmin.m_vertices) {
-            if (is_species(u, gmin)) {
-                overlapping_min_chars.erase(u);
+            if (is_character(u, gmin)) {
+                overlapping_min_chars.push_back(u);
             }
         }
 
         std::list<RBVertex> candidate_chars = get_adj_vertices(candidate, gmin);
         for (RBVertex u : candidate_chars) {
-            overlapping_min_chars.erase(u);
+            overlapping_min_chars.remove(u);
         }
 
         for (RBVertex u : max_chars_of_gmin) {
-            overlapping_min_chars.erase(u);
+            overlapping_min_chars.remove(u);
         }
 
-        for (RBVertex z : overlapping_min_chars) {
+        overlapping_min_chars.remove_if([&](const RBVertex z) {
             for (RBVertex u : candidate_chars) {
                 if (!overlaps_character(z, u, gmin)) {
-                    overlapping_min_chars.erase(z);
+                    return true;
                 }
             }
-        }
+            return false;
+        });
 
         // check for the red-sigma graph
         RBGraph g_copy;
@@ -596,53 +1034,114 @@ bool is_m_solvable(std::list<RBVertex> &sources, const RBGraph &gm) {
     return true;
 }
 
-std::list<RBVertex> closure(const RBVertex &v,
-                            const RBGraph &g)//C(S) char massimali
-{
-    //CL(s) is defined as follows: a ∈ CL(s) if and only if a is minimal in G and moreover it is
-    //included in all maximal characters of s.
+ClosureTable::ClosureTable(const RBGraph &g) {
+    const std::list<RBVertex> cmax = maximal_characters(g);
+    const std::set<RBVertex> cmax_set(cmax.begin(), cmax.end());
 
-    // get the minimal characters as follow:
     // cmin = vertices(g) - cmax - species(g)
+    for (RBVertex v : g.m_vertices)
+        if (!is_species(v, g) && cmax_set.count(v) == 0)
+            cmin.push_back(v);
 
-    std::list<RBVertex> cmax = maximal_characters(g);
-    std::list<RBVertex> cmin(g.m_vertices.begin(), g.m_vertices.end());
-    RBVertexIter b = cmin.begin(), e = cmin.end(), next;
-    for (next = b; b != e; b = next) {
-        ++next;
-        if (is_species(*b, g)) {
-            cmin.remove(*b);
-        }
-        for (RBVertex u : cmax) {
-            if (g[*b].name == g[u].name) {
-                cmin.remove(*b);
-                break;
-            }
+    words = (cmin.size() + 63) / 64;
+
+    // species of each character, as bitsets
+    std::unordered_map<RBVertex, size_t> species_bit;
+    for (RBVertex v : g.m_vertices) {
+        if (is_species(v, g)) {
+            const size_t bit = species_bit.size();
+            species_bit[v] = bit;
         }
     }
 
-    // keep just the max chars of v
-    b = cmax.begin(), e = cmax.end();
-    for (next = b; b != e; b = next) {
-        ++next;
-        if (!exists(*b, v, g)) {
-            cmax.remove(*b);
+    const size_t species_words = (species_bit.size() + 63) / 64;
+    auto species_of = [&](const RBVertex c) {
+        std::vector<uint64_t> bits(species_words, 0);
+        for (RBVertex s : get_adj_vertices(c, g)) {
+            const size_t bit = species_bit.at(s);
+            bits[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+        return bits;
+    };
+
+    std::vector<std::vector<uint64_t>> cmin_species;
+    for (RBVertex c : cmin)
+        cmin_species.push_back(species_of(c));
+
+    // included[u] = the characters of cmin included in the maximal character u
+    std::unordered_map<RBVertex, std::vector<uint64_t>> included;
+    for (RBVertex u : cmax) {
+        const std::vector<uint64_t> u_species = species_of(u);
+        std::vector<uint64_t> &bits = included[u];
+        bits.assign(words, 0);
+
+        for (size_t i = 0; i < cmin.size(); ++i) {
+            bool subset = true;
+            for (size_t w = 0; w < species_words && subset; ++w)
+                subset = ((cmin_species[i][w] & ~u_species[w]) == 0);
+
+            if (subset)
+                bits[i / 64] |= uint64_t(1) << (i % 64);
         }
     }
 
-    // keep just the min chars that are included in all max chars of v
-    b = cmin.begin(), e = cmin.end();
-    for (next = b; b != e; b = next) {
-        ++next;
-        for (RBVertex u : cmax) {
-            if (!includes_characters(u, *b, g)) {
-                cmin.remove(*b);
-                break;
+    // closure of s = AND of included[u] over the maximal characters u of s
+    for (const auto &s : species_bit) {
+        std::vector<uint64_t> bits;
+        for (RBVertex u : get_adj_vertices(s.first, g)) {
+            const auto u_included = included.find(u);
+            if (u_included == included.end())
+                continue;
+
+            if (bits.empty()) {
+                bits = u_included->second;
+            } else {
+                for (size_t w = 0; w < words; ++w)
+                    bits[w] &= u_included->second[w];
             }
         }
+
+        if (!bits.empty())
+            species_closure[s.first] = std::move(bits);
     }
+}
+
+
+std::list<RBVertex> ClosureTable::closure(const RBVertex &s) const {
+    const auto bits = species_closure.find(s);
+
+    // with no maximal characters, every character of cmin is in the closure
+    if (bits == species_closure.end())
+        return std::list<RBVertex>(cmin.begin(), cmin.end());
+
+    std::list<RBVertex> output;
+    for (size_t i = 0; i < cmin.size(); ++i)
+        if ((bits->second[i / 64] >> (i % 64)) & 1)
+            output.push_back(cmin[i]);
 
-    return cmin;
+    return output;
+}
+
+
+const ClosureTable &closure_table(const RBGraph &g) {
+    thread_local std::unique_ptr<ClosureTable> table;
+    thread_local const RBGraph *table_graph = nullptr;
+    thread_local size_t table_version = 0;
+
+    if (!table || table_graph != &g || table_version != version(g)) {
+        table = std::make_unique<ClosureTable>(g);
+        table_graph = &g;
+        table_version = version(g);
+    }
+
+    return *table;
+}
+
+
+std::list<RBVertex> closure(const RBVertex &v, const RBGraph &g) {
+    //CL(s) is defined as follows: a ∈ CL(s) if and only if a is minimal in G and moreover it is
+    //included in all maximal characters of s.
+    return closure_table(g).closure(v);
 }
 
 ////////////////////////////////////////////////
@@ -770,8 +1269,11 @@ bool type_one(const RBGraph &g, const RBVertex &main_source,
             // for-each B left
             if (!found_B) {
                 bool pass = true;
+                const ComponentIndex &index = component_index(g);
                 for (RBVertex v : leaf_species) {
-                    if (contains(get_comp_vertex(v, g), *b_B)) {
+                    // *b_B is in get_comp_vertex(v, g)
+                    if (g[v].type != g[*b_B].type &&
+                        index.component_id(v) == index.component_id(*b_B)) {
                         // pass FALSE
                         pass = false;
                         break;
@@ -813,56 +1315,24 @@ bool test_l_source(const RBVertex &s1, const RBVertex &s2,
     // prendo le componenti di s1 in g
     std::list<RBVertex> s1_max_chars = get_comp_vertex(s1, g);
 
-    // prendo i max char di g
-    std::list<RBVertex> cmax = maximal_characters(g);
-
-    // computo i min char di g, rimuovendo le specie e rimuovendo i char maximali dall'iterator di vertici di g
-    std::list<RBVertex> cmin(g.m_vertices.begin(), g.m_vertices.end());
-    RBVertexIter b = cmin.begin(), e = cmin.end(), next;
-
-    for (next = b; b != e; b = next) {
-        ++next;
-        if (is_species(*b,
-                       g)) {// se e' specie, rimuovila
-            cmin.remove(*b);
-        }
-        for (RBVertex u : cmax) {
-            if (g[*b].name == g[u].name) {
-                cmin.remove(*b);
-                break;
-            }
-        }
-    }
+    // computo i min char di g: caratteri non specie e non massimali
+    const ClosureTable &table = closure_table(g);
+    const std::set<RBVertex> cmin(table.minimal().begin(), table.minimal().end());
 
     // rimuovo dalle componenti di s1, i char minimali
-    b = s1_max_chars.begin(), e = s1_max_chars.end(), next;
-    for (next = b; b != e; b = next) {
-        ++next;
-        for (RBVertex u : cmin) {
-            if (g[*b].name == g[u].name) {
-                s1_max_chars.remove(*b);
+    s1_max_chars.remove_if([&](const RBVertex v) { return cmin.count(v) > 0; });
+    // got s1_max_chars
+
+    // riga 3 algoritmo --> se il primo carattere di C_s (s1_max_chars) include
+    // un char minimale, computo la closure
+    if (!s1_max_chars.empty()) {
+        for (RBVertex a : cmin) {
+            if (includes_characters(s1_max_chars.front(), a, g)) {
+                tmp = table.closure(s1);
+                //tmp.push_back(a);// serve??? CL(s) = {a} U CL(s)
                 break;
             }
         }
-    }// got s1_max_chars
-
-    // riga 3 algoritmo --> per ogni a in cmin
-    bool included = true;
-    for (RBVertex a : cmin) {
-        b = cmin.begin(), e = cmin.end();
-        for (next = b; b != e; b = next) {
-            ++next;
-            for (RBVertex u : s1_max_chars) {
-                if (!includes_characters(u, *b, g)) {
-                    included = false;
-                    break;
-                } else {// se ogni u *carattere di C_s ovvero di s1_max_chars* include il char a
-                    // allora computo la closure
-                    tmp = closure(s1, g);
-                    //tmp.push_back(a);// serve??? CL(s) = {a} U CL(s)
-                }
-            }
-        }
     }
 
     // computo s-graph : sottografo di G indotto da C_s U CL(s)
@@ -1114,116 +1584,139 @@ ppr_general(RBGraph &g) /*, std::list<SignedCharacter> a) */
 
     // ** found that gmin->g-max-red it's the same as computing a g-skelton (making a graph from all Inactive max char plus all active chars
 
+    MemoScope memo_scope;
+
+    // the graph as given, on which the exponential search restarts if the
+    // heuristics lead to a graph with no reduction
+    RBGraph g_input;
+    if (exponential::enabled)
+        copy_graph(g, g_input);
+
     if (logging::enabled) {
         std::cout << "[INFO] Realizing chars" << std::endl;
     }
     std::list<SignedCharacter> realized_chars =
         realize_red_univ_and_univ_chars(g).first;
-    remove_duplicate_species(g);
     std::list<SignedCharacter> tmp;
 
-    if (logging::enabled) {
-        std::cout << "[INFO] Running PPPH iteration " << std::endl;
-    }
-
-    while (!is_empty(g)) {
-
-        RBGraph gm;
-        RBGraph g_max;
-        RBGraph g_min;
-        std::cout << "GUARD_PRINT_TREE\n" << g <<  std::endl;
+    try {
+        remove_duplicate_species(g);
 
+        // the maximal characters of g are kept up to date by the realizations
+        MaximalIndexScope maximal_scope(g);
+        DerivedGraphs derived(g);
 
         if (logging::enabled) {
-            std::cout << "[INFO] Computing minimal form" << std::endl;
+            std::cout << "[INFO] Running PPPH iteration " << std::endl;
         }
-        minimal_form_graph(g, g_min);
 
-        if (logging::enabled) {
-            std::cout << "[INFO] Computing g-skeleton" << std::endl;
-        }
-        g_skeleton(g, gm);
-        std::cout << "GUARD_PRINT_SKELETON\n" << gm <<  std::endl;
+        while (!is_empty(g)) {
+            check_deadline("ppr_general");
 
-        if (logging::enabled) {
-            std::cout << "[INFO] Computing max_red_graph" << std::endl;
-        }
-        maximal_reducible_graph(g_min, g_max, true);
 
-        // need this in advance for realizing characters, do this before the main loop
-        if (logging::enabled) {
-            std::cout << "[INFO] Getting Sources" << std::endl;
-        }
-        std::list<RBVertex> gm_sources = get_sources(gm);
+            std::cout << "GUARD_PRINT_TREE\n" << g <<  std::endl;
 
-        if (is_2_solvable(gm_sources, gm)) {
+            // the derived graphs are built when first used in this iteration
+            const RBGraph &gm = derived.skeleton();
+            std::cout << "GUARD_PRINT_SKELETON\n" << gm <<  std::endl;
 
-            tmp =
-                realize_species(source_2_solvable(gm_sources, gm, g_min, g), g)
-                    .first;
+            std::list<RBVertex> &gm_sources = derived.sources();
 
-            if (logging::enabled) {
-                std::cout << "[INFO] 2-solvable " << std::endl;
-            }
-            std::cout << "GUARD_A 2_SOLVABLE" << std::endl;
+            if (is_2_solvable(gm_sources, gm)) {
 
+                RBVertex source = nullptr;
+                try {
+                    source = source_2_solvable(gm_sources, gm, derived.minimal_form(), g);
+                } catch (const TimeoutError &) {
+                    throw;
+                } catch (const std::runtime_error &) {
+                    // the heuristic found no source to realize
+                    if (!exponential::enabled)
+                        throw;
+                }
 
-            //} else if (!is_2_solvable(sources_skeleton, gm)) {
-            // return result; // skip controls,
-        } else if (is_degenerate(gm)) {
-            if (logging::enabled) {
-                std::cout << "[INFO] is-degenerate " << std::endl;
-            }
-            //            throw std::runtime_error("[ERROR] In ppr_general: could not "
-            //                                     "compute persistent phylogeny");
-            break;
-        } else {
-            if (logging::enabled) {
-                std::cout << "[INFO] no-2-solv " << std::endl;
-            }
-            break;
-            //            throw std::runtime_error("[ERROR] In ppr_general: could not "
-            //                                     "compute persistent phylogeny");
-            // red sigmagraph??
-        }
+                tmp = (source != nullptr ? realize_species(source, g).first
+                                         : ppp_exponential(g));
 
-        if (!tmp.empty()) {
-            if (logging::enabled)
-                std::cout << "[INFO] realization not empty " << std::endl;
+                if (logging::enabled) {
+                    std::cout << "[INFO] 2-solvable " << std::endl;
+                }
+                std::cout << "GUARD_A 2_SOLVABLE" << std::endl;
 
-            // realize result in G
-            //update G and A
-            // A set of characters of r (relized chars)
 
-            realized_chars.splice(realized_chars.end(), tmp);
-            realized_chars.splice(realized_chars.end(),
-                                  realize_red_univ_and_univ_chars(g).first);
-            remove_duplicate_species(g);
-            // iterates over connected components
-            if (!is_empty(g)) {
+                //} else if (!is_2_solvable(sources_skeleton, gm)) {
+                // return result; // skip controls,
+            } else if (is_degenerate(gm)) {
+                if (logging::enabled) {
+                    std::cout << "[INFO] is-degenerate " << std::endl;
+                }
+                //            throw std::runtime_error("[ERROR] In ppr_general: could not "
+                //                                     "compute persistent phylogeny");
+                if (!exponential::enabled)
+                    break;
+
+                tmp = ppp_exponential(g);
+            } else {
+                if (logging::enabled) {
+                    std::cout << "[INFO] no-2-solv " << std::endl;
+                }
+                if (!exponential::enabled)
+                    break;
+
+                tmp = ppp_exponential(g);
+                //            throw std::runtime_error("[ERROR] In ppr_general: could not "
+                //                                     "compute persistent phylogeny");
+                // red sigmagraph??
+            }
+
+            if (!tmp.empty()) {
                 if (logging::enabled)
-                    std::cout << "[INFO] Iterating conn_cmpt " << std::endl;
-                std::cout << "GUARD_ITERATING_COMPT" << std::endl;
-                RBGraphVector conn_compnts = connected_components(g);
-                auto cc = conn_compnts.begin();
-                auto cc_end = conn_compnts.end();
-                for (; cc != cc_end; ++cc) {
-                    RBGraph tmp_graph;
-                    copy_graph(*cc->get(), tmp_graph);
-                    tmp = ppr_general(*cc->get());
-                    for (RBVertex v : tmp_graph.m_vertices) {
-                        remove_vertex(tmp_graph[v].name, g);
-                    }
-                    realized_chars.splice(realized_chars.end(), tmp);
+                    std::cout << "[INFO] realization not empty " << std::endl;
 
+                // realize result in G
+                //update G and A
+                // A set of characters of r (relized chars)
+
+                realized_chars.splice(realized_chars.end(), tmp);
+                realized_chars.splice(realized_chars.end(),
+                                      realize_red_univ_and_univ_chars(g).first);
+                remove_duplicate_species(g);
+                // iterates over connected components
+                if (!is_empty(g)) {
                     if (logging::enabled)
-                        std::cout << "[INFO] Realized chars ";
-                    for (SignedCharacter sc : realized_chars)
-                        std::cout << "(" << sc << ") ";
-                    std::cout << std::endl;
+                        std::cout << "[INFO] Iterating conn_cmpt " << std::endl;
+                    std::cout << "GUARD_ITERATING_COMPT" << std::endl;
+                    RBGraphVector conn_compnts = connected_components(g);
+                    auto cc = conn_compnts.begin();
+                    auto cc_end = conn_compnts.end();
+                    for (; cc != cc_end; ++cc) {
+                        RBGraph tmp_graph;
+                        copy_graph(*cc->get(), tmp_graph);
+                        tmp = solve_component(*cc->get(), "general", ppr_general);
+                        for (RBVertex v : tmp_graph.m_vertices) {
+                            remove_vertex(tmp_graph[v].name, g);
+                        }
+                        realized_chars.splice(realized_chars.end(), tmp);
+
+                        if (logging::enabled)
+                            std::cout << "[INFO] Realized chars ";
+                        for (SignedCharacter sc : realized_chars)
+                            std::cout << "(" << sc << ") ";
+                        std::cout << std::endl;
+                    }
                 }
             }
         }
+    } catch (TimeoutError &e) {
+        // the characters realized so far are part of the partial result
+        e.prepend(realized_chars);
+        throw;
+    } catch (const std::runtime_error &) {
+        if (!exponential::enabled)
+            throw;
+
+        realized_chars = ppp_exponential(g_input);
+        clear(g);
     }
     return realized_chars;
 }
@@ -10,6 +10,10 @@
 #define FUNCTIONS_HPP
 
 #include "rbgraph.hpp"
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
 
 // ************************************************
 // ************************************************
@@ -75,6 +79,191 @@ inline bool operator==(const SignedCharacter &a, const SignedCharacter b) {
     return (a.character == b.character && a.state == b.state);
 }
 
+/**
+  Point in time after which the solvers stop
+*/
+typedef std::chrono::steady_clock::time_point Deadline;
+
+/**
+  @brief Exception thrown by a solver that reaches its deadline
+
+  The exception carries the phase that was running and the characters realized
+  until then; each solver it goes through prepends the characters it realized
+  before calling the solver that timed out.
+*/
+class TimeoutError : public std::runtime_error {
+public:
+    /**
+      @brief Build the exception thrown in the phase \e phase .
+    */
+    explicit TimeoutError(const std::string &phase)
+            : std::runtime_error("[ERROR] Timed out in phase " + phase), phase_(phase) {}
+
+    /**
+      @brief Return the phase that was running.
+    */
+    const std::string &phase() const { return phase_; }
+
+    /**
+      @brief Return the characters realized before the deadline.
+    */
+    const std::list<SignedCharacter> &realized() const { return realized_; }
+
+    /**
+      @brief Prepend \e lsc to the characters realized before the deadline.
+    */
+    void prepend(const std::list<SignedCharacter> &lsc) {
+        realized_.insert(realized_.begin(), lsc.begin(), lsc.end());
+    }
+
+private:
+    std::string phase_;                      ///< Phase that was running
+    std::list<SignedCharacter> realized_{};  ///< Characters realized before the deadline
+};
+
+/**
+  @brief Scope of the deadline of the solvers in the current thread.
+
+  The deadline is local to the thread, and the previous one is restored when
+  the scope ends.
+*/
+class DeadlineScope {
+public:
+    /**
+      @brief Set the deadline of the current thread to \e deadline .
+    */
+    explicit DeadlineScope(const Deadline &deadline);
+
+    ~DeadlineScope();
+
+    DeadlineScope(const DeadlineScope &) = delete;
+
+    DeadlineScope &operator=(const DeadlineScope &) = delete;
+
+private:
+    Deadline previous;  ///< Deadline restored at the end of the scope
+};
+
+/**
+  @brief Return the deadline of the current thread (Deadline::max() if none).
+*/
+Deadline get_deadline();
+
+/**
+  @brief Cancellation checkpoint of the solvers.
+
+  @param[in] phase Phase that is running
+
+  @throws TimeoutError if the deadline of the current thread has passed
+*/
+void check_deadline(const std::string &phase);
+
+/**
+  @brief Class used to build the graphs derived from a red-black graph once
+  per version of the graph
+
+  Each derived graph is built on its first use, and it is reused until the
+  version of the graph changes; the graphs that are never used are never
+  built.
+*/
+class DerivedGraphs {
+public:
+    /**
+      @brief Derive the graphs from \e g, which must outlive the object.
+    */
+    explicit DerivedGraphs(const RBGraph &g) : g(g), min_scope(g_min) {}
+
+    DerivedGraphs(const DerivedGraphs &) = delete;
+
+    DerivedGraphs &operator=(const DerivedGraphs &) = delete;
+
+    /**
+      @brief Return the minimal form graph of g (see minimal_form_graph).
+    */
+    const RBGraph &minimal_form();
+
+    /**
+      @brief Return the g-skeleton of g (see g_skeleton).
+    */
+    const RBGraph &skeleton();
+
+    /**
+      @brief Return the maximal reducible graph of the minimal form graph of
+      g, with its active characters (see maximal_reducible_graph).
+    */
+    const RBGraph &maximal_reducible();
+
+    /**
+      @brief Return the sources of the g-skeleton of g (see get_sources).
+    */
+    std::list<RBVertex> &sources();
+
+private:
+    /**
+      Version of g from which no graph has been derived
+    */
+    static const size_t none = static_cast<size_t>(-1);
+
+    const RBGraph &g;               ///< Red-black graph
+    RBGraph g_min{};                ///< Minimal form graph
+    RBGraph gm{};                   ///< g-skeleton
+    RBGraph g_max{};                ///< Maximal reducible graph of g_min
+    std::list<RBVertex> gm_sources{};  ///< Sources of gm
+    MaximalIndexScope min_scope;    ///< Maximal characters of g_min, queried more than once
+
+    size_t min_version = none;      ///< Version of g of g_min
+    size_t skeleton_version = none; ///< Version of g of gm
+    size_t max_version = none;      ///< Version of g of g_max
+    size_t sources_version = none;  ///< Version of g of gm_sources
+};
+
+/**
+  @brief Class used to compute the closure of every species of a graph at once
+
+  Let cmin be the characters of the graph that are not maximal. For each
+  maximal character u, the table keeps the bitset over cmin of the
+  characters included in u; the closure of a species s is then the AND of the
+  bitsets of the maximal characters of s, a word at a time.
+*/
+class ClosureTable {
+public:
+    /**
+      @brief Compute the closure of each species of \e g .
+    */
+    explicit ClosureTable(const RBGraph &g);
+
+    /**
+      @brief Return the characters of g that are not maximal, in the order of
+      the vertices of g.
+    */
+    const std::vector<RBVertex> &minimal() const { return cmin; }
+
+    /**
+      @brief Return the closure of \e s (see closure).
+    */
+    std::list<RBVertex> closure(const RBVertex &s) const;
+
+private:
+    std::vector<RBVertex> cmin{};   ///< Characters that are not maximal
+    size_t words{};                 ///< Number of words of a bitset over cmin
+    std::unordered_map<RBVertex, std::vector<uint64_t>> species_closure{};  ///< Closure
+    ///< of each species with a maximal character, as a bitset over cmin
+};
+
+
+/**
+  @brief Return the closure table of \e g .
+
+  The table of the last graph and version asked by the current thread is
+  kept, so it is computed once per version of \e g ; the reference is valid
+  until the table of another graph or version is asked.
+
+  @param[in] g Red-black graph
+
+  @return Closure table of g
+*/
+const ClosureTable &closure_table(const RBGraph &g);
+
 // ************************************************
 // ************************************************
 
@@ -137,6 +326,11 @@ std::pair<std::list<SignedCharacter>, bool> realize_species(const RBVertex v,
   of \e lsc are feasible for \e g.
   Returns an empty list and bool = False otherwise.
 
+  The characters are realized one after the other, as by realize_character,
+  but the connected components of \e g are labelled once, and only the
+  components changed by a realization are visited again; the isolated
+  vertices are deleted once, after the last realization.
+
   @param[in]     lsc List of signed characters of \e g
   @param[in,out] g   Red-black graph
 
@@ -163,6 +357,9 @@ void sort_by_degree(std::list<RBVertex> &list_to_sort, const RBGraph &g);
   @brief Return the minimal p-active species in \e g.
   
   If \e all is set to false, then the output list will contain only the first minimal p-active species encountered.
+  The species including each active species are taken from the Hasse diagram
+  of the worklists of \e g (see SpeciesHasse), or of a diagram built for the
+  call if \e g has no worklists.
 
   @param[in] g Red-black graph
   @param[in] all bool
@@ -177,7 +374,7 @@ std::list<RBVertex> get_all_minimal_p_active_species(const RBGraph &g, bool all
 
   @param[in] g Red-black graph
 
-  @return The minimal p-active species
+  @return The minimal p-active species, or nullptr if there is none
 */
 RBVertex get_minimal_p_active_species(const RBGraph &g);
 
@@ -195,10 +392,120 @@ RBVertex get_minimal_p_active_species(const RBGraph &g);
 RBVertex get_quasi_active_species(const RBGraph &g);
 
 
+/**
+  @brief Struct used to count the evaluations of a rule
+*/
+struct RuleCounters {
+    size_t evaluations = 0;            ///< Times the rule has been tested
+    size_t hits = 0;                   ///< Times the rule has been applied
+    std::chrono::nanoseconds cost{0};  ///< Time spent testing and applying the rule
+};
+
+
+/**
+  @brief Class used to select the rule applied at each step of a reduction
+
+  A rule is made of a test, which looks for a witness of the rule in the
+  graph, and an action, which applies the rule to the witness. At each step
+  the rules are tested in order, each one at most once, and the first one
+  that matches is applied to the witness found by its test. The time spent on
+  each rule is added to the counters of the current thread (see
+  rule_counters).
+*/
+class RuleEngine {
+public:
+    /**
+      Test of a rule: return true if the rule matches \e g, setting witness
+    */
+    typedef std::function<bool(const RBGraph &g, RBVertex &witness)> Test;
+
+    /**
+      Action of a rule: apply the rule to \e witness and return the realized
+      characters
+    */
+    typedef std::function<std::list<SignedCharacter>(RBGraph &g, RBVertex witness)> Action;
+
+    /**
+      @brief Add the rule \e name at the end of the order.
+    */
+    void add_rule(const std::string &name, Test test, Action action);
+
+    /**
+      @brief Set the order of the rules to \e order, a comma-separated list of
+      rule names; the rules not listed are not used.
+
+      @throws std::runtime_error if a name is not the name of a rule
+    */
+    void set_order(const std::string &order);
+
+    /**
+      @brief Return true if the rule \e name is used.
+    */
+    bool uses(const std::string &name) const;
+
+    /**
+      @brief Apply the first rule that matches \e g .
+
+      @param[in,out] g        Red-black graph
+      @param[out]    realized Realized characters, extended with the new ones
+
+      @return False if no rule matches g
+    */
+    bool step(RBGraph &g, std::list<SignedCharacter> &realized);
+
+private:
+    /**
+      @brief Struct used to represent a rule
+    */
+    struct Rule {
+        std::string name{};   ///< Name of the rule
+        Test test{};          ///< Test of the rule
+        Action action{};      ///< Action of the rule
+    };
+
+    std::vector<Rule> rules{};     ///< Rules, in the order they were added
+    std::vector<size_t> order{};   ///< Rules used, in the order they are tested
+};
+
+
+/**
+  @brief Return the counters of the rules run by the current thread, by name.
+*/
+const std::map<std::string, RuleCounters> &rule_counters();
+
+
+/**
+  @brief Reset the counters of the rules run by the current thread.
+*/
+void reset_rule_counters();
+
+
+/**
+  @brief Add \e counters, taken from another thread, to the counters of the
+  rules run by the current thread.
+*/
+void add_rule_counters(const std::map<std::string, RuleCounters> &counters);
+
+
+/**
+  @brief Return the rules of ppp_maximal_reducible_graphs, in their default
+  order: pending, p-active, degenerate, active, quasi-active, exponential.
+*/
+RuleEngine reduction_rules();
+
+
 /**
   @brief Execute the algorithm on the maximal reducible graph \e g .
   It returns the sequence of the realized characters.
 
+  At each step the rules returned by reduction_rules are tested in the order
+  given by rules::order (the default order if empty), and the first one that
+  matches is applied.
+
+  The choices of the rules can lead to a graph with no reduction even if \e g
+  has one: if the exponential rule is used and exponential::enabled, the
+  exponential search is then run again on \e g as it was given.
+
   @param[in] g Red-black graph
 
   @return List
@@ -206,9 +513,27 @@ RBVertex get_quasi_active_species(const RBGraph &g);
 std::list<SignedCharacter> ppp_maximal_reducible_graphs(RBGraph &g);
 
 
+/**
+  @brief Return the characters of \e g that are red-universal, as c-, or
+  universal, as c+, in the order of the vertices of \e g .
+
+  The characters are found in one pass, by comparing the degree of each
+  character with the number of species in its connected component.
+
+  @param[in] g Red-black graph
+
+  @return List of signed characters
+*/
+std::list<SignedCharacter> universal_characters(const RBGraph &g);
+
+
 /**
   @brief Realize the characters in \e g that are red-universal or universal.
 
+  The characters found by universal_characters are realized together, and the
+  isolated vertices are removed once for all of them, until \e g has no
+  red-universal or universal characters.
+
   @param[in,out] g Red-black graph
 
   @return Realized characters (list of signed characters)
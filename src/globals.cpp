@@ -11,19 +11,87 @@
 //=============================================================================
 // Output modifiers
 
-bool logging::enabled = false;
+thread_local bool logging::enabled = false;
 
-bool general::enabled = false;
+thread_local bool general::enabled = false;
 
-bool print_graph::enabled = false;
+thread_local bool print_graph::enabled = false;
 //=============================================================================
 // Algorithm modifiers
 
-bool exponential::enabled = false;
+thread_local bool exponential::enabled = false;
 
-bool interactive::enabled = false;
+thread_local size_t exponential::threads = 0;
 
-size_t nthsource::index = 0;
+thread_local bool bitgraph::enabled = false;
 
-bool active::enabled = false;
+thread_local bool interactive::enabled = false;
 
+thread_local size_t nthsource::index = 0;
+
+thread_local bool active::enabled = false;
+
+thread_local size_t timeout::ms = 0;
+
+thread_local bool preprocess::enabled = false;
+
+thread_local bool memo::enabled = true;
+
+thread_local std::string cache::directory = "";
+
+thread_local std::string rules::order = "";
+
+std::string server::socket = "";
+
+size_t server::workers = 0;
+
+//=============================================================================
+// Options of a thread
+
+GlobalOptions get_options() {
+    GlobalOptions options;
+    options.logging = logging::enabled;
+    options.general = general::enabled;
+    options.print_graph = print_graph::enabled;
+    options.exponential = exponential::enabled;
+    options.exponential_threads = exponential::threads;
+    options.bitgraph = bitgraph::enabled;
+    options.interactive = interactive::enabled;
+    options.nthsource = nthsource::index;
+    options.active = active::enabled;
+    options.timeout_ms = timeout::ms;
+    options.preprocess = preprocess::enabled;
+    options.memo = memo::enabled;
+    options.cache_directory = cache::directory;
+    options.rule_order = rules::order;
+
+    return options;
+}
+
+/**
+  @brief Set the options of the current thread to \e options .
+*/
+static void set_options(const GlobalOptions &options) {
+    logging::enabled = options.logging;
+    general::enabled = options.general;
+    print_graph::enabled = options.print_graph;
+    exponential::enabled = options.exponential;
+    exponential::threads = options.exponential_threads;
+    bitgraph::enabled = options.bitgraph;
+    interactive::enabled = options.interactive;
+    nthsource::index = options.nthsource;
+    active::enabled = options.active;
+    timeout::ms = options.timeout_ms;
+    preprocess::enabled = options.preprocess;
+    memo::enabled = options.memo;
+    cache::directory = options.cache_directory;
+    rules::order = options.rule_order;
+}
+
+OptionsScope::OptionsScope(const GlobalOptions &options) : previous(get_options()) {
+    set_options(options);
+}
+
+OptionsScope::~OptionsScope() {
+    set_options(previous);
+}
@@ -9,6 +9,7 @@
 #ifndef GLOBALS_HPP
 #define GLOBALS_HPP
 
+#include <cstddef>
 #include <list>
 #include <string>
 
@@ -19,15 +20,15 @@
   @brief Global logging namespace
 */
 namespace logging {
-    extern bool enabled;  ///< Logging toggle
+    extern thread_local bool enabled;  ///< Logging toggle
 };
 
 namespace general {
-    extern bool enabled;
+    extern thread_local bool enabled;
 };
 
 namespace print_graph {
-    extern bool enabled;
+    extern thread_local bool enabled;
 };
 
 //=============================================================================
@@ -37,28 +38,133 @@ namespace print_graph {
   @brief Global exponential algorithm namespace
 */
 namespace exponential {
-    extern bool enabled;  ///< Exponential algorithm toggle
+    extern thread_local bool enabled;  ///< Exponential algorithm toggle
+    extern thread_local size_t threads;  ///< Threads of the exponential algorithm and of the conflict components (0 for one per core)
+};
+
+/**
+  @brief Global bit graph engine namespace
+*/
+namespace bitgraph {
+    extern thread_local bool enabled;  ///< Exponential algorithm on packed bit matrices toggle
 };
 
 /**
   @brief Global user interaction namespace
 */
 namespace interactive {
-    extern bool enabled;  ///< User interaction toggle
+    extern thread_local bool enabled;  ///< User interaction toggle
 };
 
 /**
   @brief Global safe source selection namespace
 */
 namespace nthsource {
-    extern size_t index;  ///< Safe source index selection
+    extern thread_local size_t index;  ///< Safe source index selection
 };
 
 /**
   @brief Global active character filter namespace
 */
 namespace active {
-    extern bool enabled;  ///< Safe source index selection
+    extern thread_local bool enabled;  ///< Safe source index selection
+};
+
+/**
+  @brief Global time budget namespace
+*/
+namespace timeout {
+    extern thread_local size_t ms;  ///< Time budget of each matrix in milliseconds (0 if disabled)
+};
+
+/**
+  @brief Global input preprocessing namespace
+*/
+namespace preprocess {
+    extern thread_local bool enabled;  ///< Matrix reduction before building the graph toggle
+};
+
+/**
+  @brief Global component memoization namespace
+*/
+namespace memo {
+    extern thread_local bool enabled;  ///< In-run memoization of solved components toggle
+};
+
+/**
+  @brief Global result cache namespace
+*/
+namespace cache {
+    extern thread_local std::string directory;  ///< Cache directory (empty if disabled)
+};
+
+/**
+  @brief Global rule order namespace
+*/
+namespace rules {
+    extern thread_local std::string order;  ///< Comma-separated rules of the reduction (empty for the default order)
+};
+
+/**
+  @brief Global solver daemon namespace
+*/
+namespace server {
+    extern std::string socket;  ///< Unix domain socket to serve (empty if disabled)
+    extern size_t workers;      ///< Threads answering the clients (0 for one per core)
+};
+
+//=============================================================================
+// Options of a thread
+
+/**
+  @brief Struct used to copy the options of a thread
+
+  The output and algorithm modifiers are local to each thread, so that solvers
+  running in different threads can use different options; a thread copies its
+  options to the threads it starts with get_options and OptionsScope.
+*/
+struct GlobalOptions {
+    bool logging = false;            ///< logging::enabled
+    bool general = false;            ///< general::enabled
+    bool print_graph = false;        ///< print_graph::enabled
+    bool exponential = false;        ///< exponential::enabled
+    size_t exponential_threads = 0;  ///< exponential::threads
+    bool bitgraph = false;           ///< bitgraph::enabled
+    bool interactive = false;        ///< interactive::enabled
+    size_t nthsource = 0;            ///< nthsource::index
+    bool active = false;             ///< active::enabled
+    size_t timeout_ms = 0;           ///< timeout::ms
+    bool preprocess = false;         ///< preprocess::enabled
+    bool memo = true;                ///< memo::enabled
+    std::string cache_directory{};   ///< cache::directory
+    std::string rule_order{};        ///< rules::order
+};
+
+/**
+  @brief Return the options of the current thread.
+*/
+GlobalOptions get_options();
+
+/**
+  @brief Scope of the options of the current thread.
+
+  The previous options are restored when the scope ends.
+*/
+class OptionsScope {
+public:
+    /**
+      @brief Set the options of the current thread to \e options .
+    */
+    explicit OptionsScope(const GlobalOptions &options);
+
+    ~OptionsScope();
+
+    OptionsScope(const OptionsScope &) = delete;
+
+    OptionsScope &operator=(const OptionsScope &) = delete;
+
+private:
+    GlobalOptions previous;  ///< Options restored at the end of the scope
 };
 
 //=============================================================================
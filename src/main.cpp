@@ -9,11 +9,16 @@
 #include <boost/program_options.hpp>
 #include "rbgraph.hpp"
 #include "functions.hpp"
+#include "solve.hpp"
+#include "server.hpp"
 
 int main(int argc, const char *argv[]) {
     // declare the vector of input files
     std::vector<std::string> files;
 
+    // memoization of solved components is enabled unless --no-memo is given
+    bool no_memo = false;
+
     // initialize options menu
     boost::program_options::options_description general_options(
             "Usage: ppp [OPTION...] FILE..."
@@ -32,7 +37,37 @@ int main(int argc, const char *argv[]) {
 
             // option: test ppr-general algorithm
             ("general,g", boost::program_options::bool_switch(&general::enabled))
-            ("print,p", boost::program_options::bool_switch(&print_graph::enabled));
+            ("print,p", boost::program_options::bool_switch(&print_graph::enabled))
+            // option: exponential, search exactly the graphs the heuristics can not reduce
+            ("exponential,e", boost::program_options::bool_switch(&exponential::enabled),
+             "Run an exact exponential search on the graphs that the algorithm can not reduce.\n")
+            // option: threads, number of threads of the exponential search
+            ("threads", boost::program_options::value<size_t>(&exponential::threads)->value_name("N"),
+             "Use N threads for the exponential search and for the conflict components (default: one per core).\n")
+            // option: bitgraph, run the exponential search on packed bit matrices
+            ("bitgraph", boost::program_options::bool_switch(&bitgraph::enabled),
+             "Run the exponential search on packed bit matrices of species and characters instead of graphs.\n")
+            // option: timeout-ms, stop the algorithm on a matrix after a time budget
+            ("timeout-ms", boost::program_options::value<size_t>(&timeout::ms)->value_name("MS"),
+             "Stop the algorithm on a matrix after MS milliseconds, and report the characters realized until then.\n")
+            // option: preprocess, reduce the matrices before building the graphs
+            ("preprocess", boost::program_options::bool_switch(&preprocess::enabled),
+             "Collapse duplicate species and characters, drop empty ones and realize the universal characters before building the graph.\n")
+            // option: no-memo, do not reuse the results of identical components
+            ("no-memo", boost::program_options::bool_switch(&no_memo),
+             "Solve every connected component, even if an identical one has already been solved.\n")
+            // option: serve, answer the matrices sent to a Unix domain socket
+            ("serve", boost::program_options::value<std::string>(&server::socket)->value_name("SOCKET"),
+             "Keep running and answer the matrices sent by the clients of the Unix domain socket SOCKET.\n")
+            // option: workers, number of threads answering the clients
+            ("workers", boost::program_options::value<size_t>(&server::workers)->value_name("N"),
+             "Answer up to N clients at the same time with --serve (default: one per core).\n")
+            // option: cache, reuse the results stored in a directory
+            ("cache", boost::program_options::value<std::string>(&cache::directory)->value_name("DIR"),
+             "Store the results in DIR and reuse them for the same matrices, even if species or characters are permuted.\n")
+            // option: rules, order of the rules tested at each step of the reduction
+            ("rules", boost::program_options::value<std::string>(&rules::order)->value_name("LIST"),
+             "Test the rules in the order given by LIST, a comma-separated list of pending, p-active, degenerate, active, quasi-active and exponential; the rules not listed are not used.\n");
 
     // initialize hidden options (not shown in --help)
     boost::program_options::options_description hidden_options;
@@ -64,6 +99,10 @@ int main(int argc, const char *argv[]) {
                 vm);
 
         boost::program_options::notify(vm);
+
+        if (!rules::order.empty())
+            // check the rule names before processing the files
+            reduction_rules().set_order(rules::order);
     } catch (const std::exception &e) {
         // error while parsing the options given in input
         std::cerr << "Error: " << e.what() << "." << std::endl
@@ -73,6 +112,8 @@ int main(int argc, const char *argv[]) {
         return 1;
     }
 
+    memo::enabled = !no_memo;
+
     if (vm.count("help")) {
         // help option specified
         std::cerr << general_options << std::endl;
@@ -80,6 +121,11 @@ int main(int argc, const char *argv[]) {
         return 1;
     }
 
+    if (!server::socket.empty()) {
+        // daemon mode, the input files are ignored
+        return serve(server::socket);
+    }
+
     if (!vm.count("files")) {
         // no input files specified
         std::cerr << "Error: No input file specified." << std::endl
@@ -103,6 +149,9 @@ int main(int argc, const char *argv[]) {
         }
     }
 
+    // buffers of the algorithm, reused from a file to the next one
+    SolverContext context;
+
     size_t count_file = 0;
     for (const auto &file : files) {
 
@@ -115,83 +164,57 @@ int main(int argc, const char *argv[]) {
             std::cout << "Reading the matrix from the file..." << std::endl;
         }
 
-        RBGraph g;
-
         try {
-            read_graph(file, g);
+            read_matrix(file, context.matrix);
         } catch (std::runtime_error e) {
             std::cout << e.what() << std::endl;
             exit(0);
         }
 
-        if (general::enabled) {
-            if (logging::enabled) std::cout << "[INFO] Executing the PPPH algorithm on the Graph" << std::endl;
-
-
-            bool successfully_reduced = false;
-            std::list<SignedCharacter> realized_characters;
-
-            try {
-                realized_characters = ppr_general(g);
-                if (!realized_characters.empty()) {
-                    successfully_reduced = true;
-                }
-                else {
-                    successfully_reduced = false;
-                }
-            } catch (...) {
-                successfully_reduced = false;
-            }
-
-            if (!successfully_reduced) {
-                std::cout << "[RES-G] [WARNING] The graph can not be reduced!" << std::endl;
-            } else {
-                std::cout << "[RES-G] [OK] The graph" << file
-                          << " has been successfully reduced! The realized characters are: ";
-                std::cout << "<";
-                for (SignedCharacter sc : realized_characters)
-                    std::cout << "(" << sc << ") ";
-                std::cout << ">" << std::endl;
-            }
+        // result messages: [RES-G] for ppr_general, [RES] for the PPP algorithm
+        const std::string res = (general::enabled ? "[RES-G]" : "[RES]");
+        const std::string graph = (general::enabled ? "The graph" + file : "The graph");
 
+        reset_rule_counters();
+        const SolveResult *solved;
+        try {
+            solved = &solve_matrix(context);
+        } catch (const std::exception &e) {
+            // the algorithm failed for a reason other than the matrix
+            std::cout << res << " [ERROR] " << e.what() << std::endl;
             std::cout << "[INFO] Processing  \"" << file << "\"... DONE!\n" << std::endl;
+            continue;
+        }
+        const SolveResult &result = *solved;
 
-        } else {
-            if (logging::enabled) {
-                // verbosity enabled
-                std::cout << "[INFO] Extracting the maximal reducible graph..." << std::endl;
-            }
-
-            RBGraph gm;
-            maximal_reducible_graph(g, gm, false);
-            if (logging::enabled) {
-                // verbosity enabled
-                std::cout << "[INFO] Executing the PPP algorithm on the extracted maximal reducible graph..."
-                          << std::endl;
-            }
-
-            bool successfully_reduced = false;
-            std::list<SignedCharacter> realized_characters;
-
-            try {
-                realized_characters = ppp_maximal_reducible_graphs(gm);
-                successfully_reduced = true;
-            } catch (...) {
-                successfully_reduced = false;
-            }
-
-            if (!successfully_reduced) {
-                std::cout << "[RES] [WARNING] The graph can not be reduced!" << std::endl;
-            } else {
-                std::cout << "[RES] [OK] The graph has been successfully reduced! The realized characters are: ";
-                std::cout << "<";
-                for (SignedCharacter sc : realized_characters)
-                    std::cout << "(" << sc << ") ";
-                std::cout << ">" << std::endl;
+        if (logging::enabled) {
+            // verbosity enabled
+            for (const auto &rule : rule_counters()) {
+                std::cout << "[INFO] Rule " << rule.first << ": " << rule.second.hits
+                          << " hits in " << rule.second.evaluations << " evaluations, "
+                          << std::chrono::duration<double, std::milli>(rule.second.cost).count()
+                          << " ms" << std::endl;
             }
+        }
 
-            std::cout << "[INFO] Processing  \"" << file << "\"... DONE!\n" << std::endl;
+        if (result.outcome == Outcome::timeout) {
+            std::cout << res << " [TIMEOUT] " << graph << " timed out in phase " << result.phase
+                      << "! The characters realized until then are: ";
+            std::cout << "<";
+            for (SignedCharacter sc : result.realized)
+                std::cout << "(" << sc << ") ";
+            std::cout << ">" << std::endl;
+        } else if (result.outcome == Outcome::not_reduced) {
+            std::cout << res << " [WARNING] The graph can not be reduced!" << std::endl;
+        } else {
+            std::cout << res << " [OK] " << graph << " has been successfully reduced! The realized characters are: ";
+            std::cout << "<";
+            for (SignedCharacter sc : result.realized)
+                std::cout << "(" << sc << ") ";
+            std::cout << ">" << std::endl;
         }
+
+        std::cout << "[INFO] Processing  \"" << file << "\"... DONE!\n" << std::endl;
     }
     std::cout << "[INFO] Finished processing the input files. Terminated successfully." << std::endl;
     return 0;
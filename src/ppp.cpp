@@ -0,0 +1,145 @@
+/**
+ *
+ * @file ppp.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "ppp.hpp"
+#include "solve.hpp"
+
+namespace {
+
+/**
+  Buffers of the algorithm, reused by the calls of ppp::solve in a thread
+*/
+thread_local SolverContext context;
+
+
+/**
+  @brief Start the matrix \e m of \e s species and \e c characters, with the
+  active characters \e active .
+*/
+void init_matrix(const size_t s, const size_t c, const std::vector<size_t> &active,
+                 BinaryMatrix &m) {
+    if (s == 0 || c == 0)
+        throw std::runtime_error("[ERROR] In ppp::solve(): empty matrix");
+
+    for (size_t j : active) {
+        if (j >= c)
+            throw std::runtime_error("[ERROR] In ppp::solve(): Inexistent character");
+    }
+
+    m.clear();
+    m.resize(s, c);
+    m.active = active;
+    for (size_t i = 0; i < s; ++i)
+        m.row_ids.push_back(i);
+    for (size_t j = 0; j < c; ++j)
+        m.col_ids.push_back(j);
+}
+
+
+/**
+  @brief Run the algorithm on context.matrix with \e options .
+*/
+ppp::Result solve_binary(const ppp::Options &options) {
+    GlobalOptions global;
+    global.general = options.general;
+    global.exponential = options.exponential;
+    global.exponential_threads = options.threads;
+    global.bitgraph = options.bitgraph;
+    global.preprocess = options.preprocess;
+    global.memo = options.memo;
+    global.cache_directory = options.cache_directory;
+    global.timeout_ms = options.timeout_ms;
+
+    OptionsScope options_scope(global);
+    const SolveResult &result = solve_matrix(context);
+
+    ppp::Result output;
+    switch (result.outcome) {
+        case Outcome::reduced:
+            output.status = ppp::Status::reduced;
+            break;
+
+        case Outcome::not_reduced:
+            output.status = ppp::Status::not_reduced;
+            break;
+
+        case Outcome::timeout:
+            output.status = ppp::Status::timeout;
+            break;
+    }
+
+    // character c<j> is column j
+    for (const ::SignedCharacter &sc : result.realized)
+        output.realized.push_back({std::stoul(sc.character.substr(1)), sc.state == State::gain});
+    output.phase = result.phase;
+
+    return output;
+}
+
+}  // namespace
+
+
+ppp::Result ppp::solve(const DenseMatrix &m, const Options &options) {
+    if (m.bits.size() != m.num_species * m.words())
+        throw std::runtime_error("[ERROR] In ppp::solve(): wrong size of the bitset");
+
+    BinaryMatrix &matrix = context.matrix;
+    init_matrix(m.num_species, m.num_characters, m.active, matrix);
+
+    // the bits past the last column are ignored
+    for (size_t i = 0; i < m.num_species; ++i) {
+        for (size_t w = 0; w < m.words(); ++w) {
+            for (uint64_t word = m.bits[i * m.words() + w]; word != 0; word &= word - 1) {
+                const size_t j = w * 64 + __builtin_ctzll(word);
+                if (j < m.num_characters)
+                    matrix.set(i, j);
+            }
+        }
+    }
+
+    return solve_binary(options);
+}
+
+
+ppp::Result ppp::solve(const ByteMatrix &m, const Options &options) {
+    if (m.data == nullptr)
+        throw std::runtime_error("[ERROR] In ppp::solve(): no data");
+
+    BinaryMatrix &matrix = context.matrix;
+    init_matrix(m.num_species, m.num_characters, m.active, matrix);
+
+    for (size_t i = 0; i < m.num_species; ++i) {
+        // strides may be negative
+        const uint8_t *row = m.data + static_cast<ptrdiff_t>(i) * m.row_stride;
+        for (size_t j = 0; j < m.num_characters; ++j)
+            if (row[static_cast<ptrdiff_t>(j) * m.col_stride])
+                matrix.set(i, j);
+    }
+
+    return solve_binary(options);
+}
+
+
+ppp::Result ppp::solve(const SparseMatrix &m, const Options &options) {
+    if (m.rows.size() != m.num_species)
+        throw std::runtime_error("[ERROR] In ppp::solve(): wrong number of rows");
+
+    BinaryMatrix &matrix = context.matrix;
+    init_matrix(m.num_species, m.num_characters, m.active, matrix);
+
+    for (size_t i = 0; i < m.num_species; ++i) {
+        for (size_t j : m.rows[i]) {
+            if (j >= m.num_characters)
+                throw std::runtime_error("[ERROR] In ppp::solve(): column out of range");
+
+            matrix.set(i, j);
+        }
+    }
+
+    return solve_binary(options);
+}
@@ -0,0 +1,195 @@
+/**
+ *
+ * @file ppp.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ * @brief Public interface of libppp.
+ *
+ * This is the only header needed to call the solver from another program: it
+ * depends on the standard library only. Link with -lppp -pthread.
+ *
+ */
+
+#ifndef PPP_HPP
+#define PPP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+  Version of the interface of libppp, incremented on incompatible changes
+*/
+#define PPP_API_VERSION 1
+
+namespace ppp {
+
+//=============================================================================
+// Data structures
+
+
+/**
+  @brief Struct used to represent the options of a call to solve
+
+  The options are those of the command line program.
+*/
+struct Options {
+    bool general = false;           ///< Run ppr_general instead of the PPP algorithm (-g)
+    bool exponential = false;       ///< Exact search on the graphs that can not be reduced (-e)
+    size_t threads = 0;             ///< Threads of the exact search and of the conflict components, 0 for one per core (--threads)
+    bool bitgraph = false;          ///< Exact search on packed bit matrices instead of graphs (--bitgraph)
+    bool preprocess = false;        ///< Reduce the matrix before building the graph (--preprocess)
+    bool memo = true;               ///< Reuse the results of identical components (--no-memo)
+    std::string cache_directory{};  ///< Directory of the result cache, empty if disabled (--cache)
+    size_t timeout_ms = 0;          ///< Time budget in milliseconds, 0 if disabled (--timeout-ms)
+};
+
+
+/**
+  @brief Struct used to represent a binary matrix as a dense bitset
+
+  Row i is stored in the words [i * words(), (i + 1) * words()) of \e bits,
+  and column j is the bit j % 64 of the word j / 64 of its row.
+*/
+struct DenseMatrix {
+    size_t num_species{};        ///< Number of rows
+    size_t num_characters{};     ///< Number of columns
+    std::vector<uint64_t> bits{};  ///< Bitset of the rows
+    std::vector<size_t> active{};  ///< Active characters
+
+    DenseMatrix() = default;
+
+    /**
+      @brief Build a matrix of \e s species and \e c characters, all zeros.
+    */
+    DenseMatrix(const size_t s, const size_t c)
+            : num_species(s), num_characters(c), bits(s * ((c + 63) / 64), 0) {}
+
+    /**
+      @brief Return the number of words of a row.
+    */
+    size_t words() const { return (num_characters + 63) / 64; }
+
+    /**
+      @brief Return the value in row \e i and column \e j .
+    */
+    bool get(const size_t i, const size_t j) const {
+        return (bits[i * words() + j / 64] >> (j % 64)) & 1;
+    }
+
+    /**
+      @brief Set to 1 the value in row \e i and column \e j .
+    */
+    void set(const size_t i, const size_t j) {
+        bits[i * words() + j / 64] |= uint64_t(1) << (j % 64);
+    }
+};
+
+
+/**
+  @brief Struct used to represent a binary matrix as sparse lists
+
+  Each row lists the columns of its ones.
+*/
+struct SparseMatrix {
+    size_t num_species{};                     ///< Number of rows
+    size_t num_characters{};                  ///< Number of columns
+    std::vector<std::vector<size_t>> rows{};  ///< Columns of the ones of each row
+    std::vector<size_t> active{};             ///< Active characters
+};
+
+
+/**
+  @brief Struct used to view a binary matrix stored by someone else as bytes
+
+  The value in row i and column j is the byte data[i * row_stride + j *
+  col_stride], where any nonzero byte is a one. The matrix is read in place,
+  so it must not change until solve returns.
+*/
+struct ByteMatrix {
+    const uint8_t *data = nullptr;  ///< First byte of the matrix
+    size_t num_species{};           ///< Number of rows
+    size_t num_characters{};        ///< Number of columns
+    ptrdiff_t row_stride{};         ///< Bytes between two rows
+    ptrdiff_t col_stride{};         ///< Bytes between two columns
+    std::vector<size_t> active{};   ///< Active characters
+};
+
+
+/**
+  Scoped enumeration type used for the outcome of solve
+*/
+enum class Status {
+    reduced,      ///< The graph has been reduced
+    not_reduced,  ///< The graph can not be reduced
+    timeout       ///< The time budget ran out
+};
+
+
+/**
+  @brief Struct used to represent a signed character of a matrix
+*/
+struct SignedCharacter {
+    size_t character{};  ///< Column of the character
+    bool gain = true;    ///< True for c+, false for c-
+};
+
+
+/**
+  @brief Struct used to represent the result of solve
+*/
+struct Result {
+    Status status = Status::not_reduced;      ///< Outcome
+    std::vector<SignedCharacter> realized{};  ///< Realized characters (until the deadline on timeout)
+    std::string phase{};                      ///< Phase that was running on timeout
+};
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Run the algorithm on the matrix \e m with the options \e options .
+
+  Calls from different threads run in parallel, each one with its options.
+
+  @param[in] m       Binary matrix
+  @param[in] options Options
+
+  @return Result
+
+  @throws std::runtime_error if \e m is not a valid matrix
+*/
+Result solve(const DenseMatrix &m, const Options &options = Options());
+
+
+/**
+  @brief Run the algorithm on the matrix \e m with the options \e options .
+
+  @param[in] m       Binary matrix
+  @param[in] options Options
+
+  @return Result
+
+  @throws std::runtime_error if \e m is not a valid matrix
+*/
+Result solve(const SparseMatrix &m, const Options &options = Options());
+
+
+/**
+  @brief Run the algorithm on the matrix \e m with the options \e options .
+
+  @param[in] m       Binary matrix
+  @param[in] options Options
+
+  @return Result
+
+  @throws std::runtime_error if \e m is not a valid matrix
+*/
+Result solve(const ByteMatrix &m, const Options &options = Options());
+
+}  // namespace ppp
+
+#endif  // PPP_HPP
@@ -0,0 +1,573 @@
+/**
+ *
+ * @file pqtree.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "pqtree.hpp"
+
+namespace {
+
+/**
+  Node types of a PQ-tree
+*/
+enum NodeType : int {
+    leaf_node,  ///< Leaf
+    p_node,     ///< Children can be permuted arbitrarily
+    q_node      ///< Children can only be reversed
+};
+
+/**
+  Node labels used during a reduction
+*/
+enum Label : int {
+    empty,    ///< No pertinent leaf below the node
+    partial,  ///< Some pertinent leaves below the node
+    full      ///< Only pertinent leaves below the node
+};
+
+}  // namespace
+
+
+/**
+  @brief Node of a PQ-tree
+
+  The children of an internal node are linked through their unoriented sibling
+  pointers: an endmost child has a null sibling pointer, and walking a list
+  requires remembering the previous node.
+*/
+struct PQTree::Node {
+    int type = p_node;     ///< Node type
+    size_t leaf = 0;       ///< Leaf index (leaves only)
+    size_t child_count = 0;  ///< Number of children
+
+    Node *parent = nullptr;       ///< Parent, possibly a Q-node merged away
+    Node *merged_into = nullptr;  ///< Q-node this Q-node has been merged into
+    Node *sib[2] = {nullptr, nullptr};  ///< Immediate siblings
+    Node *end[2] = {nullptr, nullptr};  ///< Endmost children
+
+    // reduction state, meaningful only while stamp is the current reduction
+    size_t stamp = 0;                     ///< Reduction that last touched the node
+    int label = empty;                    ///< Label
+    bool queued = false;                  ///< Queued during the bubble-up
+    size_t pertinent_child_count = 0;     ///< Pertinent children still to process
+    size_t pertinent_leaf_count = 0;      ///< Pertinent leaves below the node
+    std::vector<Node *> full_children{};     ///< Children labeled full
+    std::vector<Node *> partial_children{};  ///< Children labeled partial
+};
+
+
+PQTree::PQTree(const size_t num_leaves) {
+    m_leaves.resize(num_leaves);
+    for (size_t i = 0; i < num_leaves; ++i) {
+        m_leaves[i] = new_node(leaf_node);
+        m_leaves[i]->leaf = i;
+    }
+
+    if (num_leaves == 1) {
+        m_root = m_leaves[0];
+    } else if (num_leaves > 1) {
+        m_root = new_node(p_node);
+        for (Node *leaf : m_leaves)
+            append_child(m_root, leaf);
+    }
+}
+
+
+PQTree::~PQTree() = default;
+
+
+PQTree::Node *PQTree::other_sibling(const Node *x, const Node *from) {
+    return (x->sib[0] == from ? x->sib[1] : x->sib[0]);
+}
+
+
+void PQTree::replace_sibling(Node *x, const Node *old_sib, Node *new_sib) {
+    if (x->sib[0] == old_sib)
+        x->sib[0] = new_sib;
+    else
+        x->sib[1] = new_sib;
+}
+
+
+PQTree::Node *PQTree::new_node(const int type) {
+    m_nodes.push_back(std::make_unique<Node>());
+    m_nodes.back()->type = type;
+    return m_nodes.back().get();
+}
+
+
+PQTree::Node *PQTree::parent_of(Node *x) {
+    Node *p = x->parent;
+    if (p == nullptr)
+        return nullptr;
+
+    // find the live Q-node that absorbed p, then compress the path to it
+    Node *root = p;
+    while (root->merged_into != nullptr)
+        root = root->merged_into;
+    while (p != root) {
+        Node *next = p->merged_into;
+        p->merged_into = root;
+        p = next;
+    }
+
+    x->parent = root;
+    return root;
+}
+
+
+void PQTree::touch(Node *x) {
+    if (x->stamp == m_stamp)
+        return;
+
+    x->stamp = m_stamp;
+    x->label = empty;
+    x->queued = false;
+    x->pertinent_child_count = 0;
+    x->pertinent_leaf_count = 0;
+    x->full_children.clear();
+    x->partial_children.clear();
+}
+
+
+int PQTree::label_of(const Node *x) const {
+    return (x->stamp == m_stamp ? x->label : empty);
+}
+
+
+void PQTree::remove_child(Node *x, Node *c) {
+    Node *a = c->sib[0], *b = c->sib[1];
+    if (a != nullptr) replace_sibling(a, c, b);
+    if (b != nullptr) replace_sibling(b, c, a);
+
+    for (Node *&e : x->end)
+        if (e == c) e = (a != nullptr ? a : b);
+
+    c->sib[0] = c->sib[1] = nullptr;
+    c->parent = nullptr;
+    --x->child_count;
+}
+
+
+void PQTree::append_child(Node *x, Node *c) {
+    attach_at_end(x, 1, c);
+}
+
+
+void PQTree::attach_at_end(Node *x, const size_t end, Node *c) {
+    Node *last = x->end[end];
+
+    c->sib[0] = last;
+    c->sib[1] = nullptr;
+    if (last != nullptr)
+        replace_sibling(last, nullptr, c);
+    else
+        x->end[1 - end] = c;
+
+    x->end[end] = c;
+    c->parent = x;
+    ++x->child_count;
+}
+
+
+void PQTree::replace_node(Node *old_node, Node *new_node) {
+    Node *p = parent_of(old_node);
+
+    new_node->parent = p;
+    new_node->sib[0] = old_node->sib[0];
+    new_node->sib[1] = old_node->sib[1];
+    for (Node *s : new_node->sib)
+        if (s != nullptr) replace_sibling(s, old_node, new_node);
+
+    if (p != nullptr) {
+        for (Node *&e : p->end)
+            if (e == old_node) e = new_node;
+    } else if (m_root == old_node) {
+        m_root = new_node;
+    }
+
+    old_node->sib[0] = old_node->sib[1] = nullptr;
+    old_node->parent = nullptr;
+}
+
+
+size_t PQTree::full_end(const Node *x) const {
+    return (label_of(x->end[0]) == full ? 0 : 1);
+}
+
+
+PQTree::Node *PQTree::group_full_children(Node *x) {
+    const std::vector<Node *> &fc = x->full_children;
+
+    if (fc.empty())
+        return nullptr;
+
+    if (fc.size() == 1) {
+        remove_child(x, fc[0]);
+        return fc[0];
+    }
+
+    Node *group = new_node(p_node);
+    touch(group);
+    group->label = full;
+    for (Node *c : fc) {
+        remove_child(x, c);
+        append_child(group, c);
+    }
+    return group;
+}
+
+
+void PQTree::merge_partial_child(Node *x, Node *c, Node *full_neighbor) {
+    // replace c by its children in the list of x, with the full end of c next
+    // to full_neighbor (or at the end of x if full_neighbor is null)
+    const size_t fe = full_end(c);
+    Node *cf = c->end[fe], *ce = c->end[1 - fe];
+    Node *other = other_sibling(c, full_neighbor);
+
+    if (full_neighbor != nullptr) {
+        replace_sibling(full_neighbor, c, cf);
+        replace_sibling(cf, nullptr, full_neighbor);
+    } else {
+        x->end[x->end[0] == c ? 0 : 1] = cf;
+    }
+
+    if (other != nullptr) {
+        replace_sibling(other, c, ce);
+        replace_sibling(ce, nullptr, other);
+    } else {
+        x->end[x->end[0] == c ? 0 : 1] = ce;
+    }
+
+    // the interior children of c keep pointing to c, which now resolves to x
+    cf->parent = x;
+    ce->parent = x;
+    c->merged_into = x;
+    x->child_count += c->child_count - 1;
+
+    c->sib[0] = c->sib[1] = nullptr;
+}
+
+
+void PQTree::bubble(const std::vector<size_t> &leaves) {
+    // walk up from the pertinent leaves, counting for every node how many of its
+    // children are pertinent; stop as soon as a single node is left, which is
+    // the root of the pertinent subtree (or the walk fell off the root)
+    std::deque<Node *> queue;
+    for (size_t l : leaves) {
+        Node *x = m_leaves[l];
+        touch(x);
+        x->queued = true;
+        x->pertinent_leaf_count = 1;
+        queue.push_back(x);
+    }
+
+    bool off_the_top = false;
+    while (queue.size() + (off_the_top ? 1 : 0) > 1) {
+        Node *x = queue.front();
+        queue.pop_front();
+
+        Node *y = parent_of(x);
+        if (y == nullptr) {
+            off_the_top = true;
+            continue;
+        }
+
+        touch(y);
+        ++y->pertinent_child_count;
+        if (!y->queued) {
+            y->queued = true;
+            queue.push_back(y);
+        }
+    }
+}
+
+
+bool PQTree::reduce(const std::vector<size_t> &leaves) {
+    if (leaves.size() <= 1)
+        return true;
+
+    ++m_stamp;
+    bubble(leaves);
+
+    std::deque<Node *> queue;
+    for (size_t l : leaves)
+        queue.push_back(m_leaves[l]);
+
+    while (!queue.empty()) {
+        Node *x = queue.front();
+        queue.pop_front();
+
+        Node *result = nullptr;
+
+        if (x->pertinent_leaf_count == leaves.size())
+            // x is the root of the pertinent subtree
+            return apply_template(x, true, result);
+
+        Node *y = parent_of(x);
+        if (!apply_template(x, false, result))
+            return false;
+
+        y->pertinent_leaf_count += x->pertinent_leaf_count;
+        if (label_of(result) == full)
+            y->full_children.push_back(result);
+        else
+            y->partial_children.push_back(result);
+
+        if (--y->pertinent_child_count == 0)
+            queue.push_back(y);
+    }
+
+    return false;
+}
+
+
+bool PQTree::apply_template(Node *x, const bool is_root, Node *&result) {
+    result = x;
+
+    switch (x->type) {
+        case leaf_node:
+            // L1
+            x->label = full;
+            return true;
+
+        case p_node:
+            return template_p_node(x, is_root, result);
+
+        default:
+            return template_q_node(x, is_root);
+    }
+}
+
+
+bool PQTree::template_p_node(Node *x, const bool is_root, Node *&result) {
+    const std::vector<Node *> &pc = x->partial_children;
+
+    if (x->full_children.size() == x->child_count) {
+        // P1
+        x->label = full;
+        return true;
+    }
+
+    if (is_root) {
+        if (pc.empty()) {
+            // P2: gather the full children under a single P-node
+            if (x->full_children.size() >= 2)
+                append_child(x, group_full_children(x));
+            return true;
+        }
+
+        if (pc.size() == 1) {
+            // P4: move the full children to the full end of the partial child
+            Node *c = pc[0];
+            const size_t fe = full_end(c);
+            Node *group = group_full_children(x);
+            if (group != nullptr)
+                attach_at_end(c, fe, group);
+
+            if (x->child_count == 1) {
+                remove_child(x, c);
+                replace_node(x, c);
+            }
+            return true;
+        }
+
+        if (pc.size() == 2) {
+            // P6: c1 + full children + reversed c2 become a single Q-node
+            Node *c1 = pc[0], *c2 = pc[1];
+            const size_t e1 = full_end(c1), e2 = full_end(c2);
+            Node *group = group_full_children(x);
+            remove_child(x, c2);
+
+            if (group != nullptr)
+                attach_at_end(c1, e1, group);
+
+            Node *a = c1->end[e1], *b = c2->end[e2], *z = c2->end[1 - e2];
+            replace_sibling(a, nullptr, b);
+            replace_sibling(b, nullptr, a);
+            c1->end[e1] = z;
+            b->parent = c1;
+            z->parent = c1;
+            c2->merged_into = c1;
+            c1->child_count += c2->child_count;
+
+            if (x->child_count == 1) {
+                remove_child(x, c1);
+                replace_node(x, c1);
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    if (pc.empty()) {
+        // P3: x becomes a partial Q-node [empty children, full children]
+        Node *group = group_full_children(x);
+        Node *q = new_node(q_node);
+        touch(q);
+        q->label = partial;
+        replace_node(x, q);
+
+        Node *empties = x;
+        if (x->child_count == 1) {
+            empties = x->end[0];
+            remove_child(x, empties);
+        }
+        append_child(q, empties);
+        append_child(q, group);
+
+        result = q;
+        return true;
+    }
+
+    if (pc.size() == 1) {
+        // P5: the partial child takes the place of x, with the full children at
+        // its full end and the empty children at its empty end
+        Node *c = pc[0];
+        remove_child(x, c);
+        Node *group = group_full_children(x);
+        replace_node(x, c);
+
+        const size_t fe = full_end(c);
+        if (group != nullptr)
+            attach_at_end(c, fe, group);
+
+        if (x->child_count > 0) {
+            Node *empties = x;
+            if (x->child_count == 1) {
+                empties = x->end[0];
+                remove_child(x, empties);
+            }
+            attach_at_end(c, 1 - fe, empties);
+        }
+
+        result = c;
+        return true;
+    }
+
+    return false;
+}
+
+
+bool PQTree::template_q_node(Node *x, const bool is_root) {
+    const std::vector<Node *> &fc = x->full_children;
+    const std::vector<Node *> &pc = x->partial_children;
+
+    if (fc.size() == x->child_count) {
+        // Q1
+        x->label = full;
+        return true;
+    }
+
+    if (pc.size() > (is_root ? 2u : 1u))
+        return false;
+
+    if (fc.empty()) {
+        if (pc.size() == 1) {
+            // Q2 without full children: the partial child must be endmost
+            Node *c = pc[0];
+            if (x->end[0] != c && x->end[1] != c)
+                return false;
+            merge_partial_child(x, c, nullptr);
+        } else {
+            // Q3 without full children: the partial children must be adjacent
+            Node *c1 = pc[0], *c2 = pc[1];
+            if (c1->sib[0] != c2 && c1->sib[1] != c2)
+                return false;
+            Node *cf1 = c1->end[full_end(c1)];
+            merge_partial_child(x, c1, c2);
+            merge_partial_child(x, c2, cf1);
+        }
+    } else {
+        // walk the run of full children in both directions from one of them:
+        // last[d] is its outermost full child and bound[d] the node beyond it
+        Node *last[2] = {fc[0], fc[0]};
+        Node *bound[2] = {nullptr, nullptr};
+        size_t run = 1;
+        for (size_t d = 0; d < 2; ++d) {
+            Node *prev = fc[0], *cur = fc[0]->sib[d];
+            while (cur != nullptr && label_of(cur) == full) {
+                ++run;
+                last[d] = cur;
+                Node *next = other_sibling(cur, prev);
+                prev = cur;
+                cur = next;
+            }
+            bound[d] = cur;
+        }
+
+        if (run != fc.size())
+            // full children are not consecutive
+            return false;
+
+        size_t bounding_partials = 0;
+        for (Node *b : bound)
+            if (b != nullptr && label_of(b) == partial)
+                ++bounding_partials;
+
+        if (bounding_partials != pc.size())
+            // a partial child is not next to the full children
+            return false;
+
+        if (!is_root && bound[0] != nullptr && bound[1] != nullptr)
+            // Q2: the full children must reach an end of x
+            return false;
+
+        for (size_t d = 0; d < 2; ++d)
+            if (bound[d] != nullptr && label_of(bound[d]) == partial)
+                merge_partial_child(x, bound[d], last[d]);
+    }
+
+    if (!is_root)
+        x->label = partial;
+    return true;
+}
+
+
+std::vector<size_t> PQTree::frontier() const {
+    std::vector<size_t> out;
+    if (m_root == nullptr)
+        return out;
+
+    out.reserve(m_leaves.size());
+
+    std::vector<Node *> stack{m_root}, children;
+    while (!stack.empty()) {
+        Node *x = stack.back();
+        stack.pop_back();
+
+        if (x->type == leaf_node) {
+            out.push_back(x->leaf);
+            continue;
+        }
+
+        children.clear();
+        Node *prev = nullptr, *cur = x->end[0];
+        while (cur != nullptr) {
+            children.push_back(cur);
+            Node *next = other_sibling(cur, prev);
+            prev = cur;
+            cur = next;
+        }
+        stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+
+    return out;
+}
+
+
+bool pq_consecutive_ones(const size_t cols, const std::vector<std::vector<size_t>> &rows,
+                         std::vector<size_t> &order) {
+    PQTree tree(cols);
+
+    for (const auto &row : rows)
+        if (!tree.reduce(row))
+            return false;
+
+    order = tree.frontier();
+    return true;
+}
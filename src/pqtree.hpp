@@ -0,0 +1,134 @@
+/**
+ *
+ * @file pqtree.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef PQTREE_HPP
+#define PQTREE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+//=============================================================================
+// Data structures
+
+
+/**
+  @brief Booth-Lueker PQ-tree over the leaves 0, ..., n-1
+
+  A PQ-tree represents a family of permutations of its leaves: the children of
+  a P-node can be permuted arbitrarily, while the children of a Q-node can only
+  be reversed. Reducing the tree with a set S restricts the family to the
+  permutations in which the leaves of S are consecutive.
+
+  The reduction follows the bubble-up / template-matching scheme by Booth and
+  Lueker. The children of a Q-node are kept in a list with unoriented sibling
+  pointers, so a partial Q-node is merged into its parent in O(1); the parent
+  pointers of its interior children are then resolved through a union-find
+  forest over the merged Q-nodes instead of being updated one by one.
+  A reduction costs O(|S| + size of the pertinent subtree), up to the inverse
+  Ackermann factor of the union-find.
+*/
+class PQTree {
+public:
+    /**
+      @brief Build the universal PQ-tree (a P-node) over \e num_leaves leaves.
+
+      @param[in] num_leaves Number of leaves
+    */
+    explicit PQTree(size_t num_leaves);
+
+    ~PQTree();
+
+    PQTree(const PQTree &) = delete;
+
+    PQTree &operator=(const PQTree &) = delete;
+
+    /**
+      @brief Reduce the tree with the set of leaves \e leaves .
+
+      When the reduction fails the tree is left in an unspecified state and must
+      not be reduced further.
+
+      @param[in] leaves Set of leaves (no duplicates)
+
+      @return True if the leaves in \e leaves can be made consecutive
+    */
+    bool reduce(const std::vector<size_t> &leaves);
+
+    /**
+      @brief Return the frontier of the tree.
+
+      The frontier is the sequence of leaves read from left to right, and it is
+      one of the permutations allowed by the tree.
+
+      @return Permutation of the leaves
+    */
+    std::vector<size_t> frontier() const;
+
+private:
+    struct Node;
+
+    static Node *other_sibling(const Node *x, const Node *from);
+
+    static void replace_sibling(Node *x, const Node *old_sib, Node *new_sib);
+
+    Node *new_node(int type);
+
+    Node *parent_of(Node *x);
+
+    void touch(Node *x);
+
+    int label_of(const Node *x) const;
+
+    void remove_child(Node *x, Node *c);
+
+    void append_child(Node *x, Node *c);
+
+    void attach_at_end(Node *x, size_t end, Node *c);
+
+    void replace_node(Node *old_node, Node *new_node);
+
+    size_t full_end(const Node *x) const;
+
+    Node *group_full_children(Node *x);
+
+    void merge_partial_child(Node *x, Node *c, Node *full_neighbor);
+
+    void bubble(const std::vector<size_t> &leaves);
+
+    bool apply_template(Node *x, bool is_root, Node *&result);
+
+    bool template_p_node(Node *x, bool is_root, Node *&result);
+
+    bool template_q_node(Node *x, bool is_root);
+
+    std::deque<std::unique_ptr<Node>> m_nodes{};  ///< Every node ever created
+    std::vector<Node *> m_leaves{};               ///< Leaf nodes by index
+    Node *m_root = nullptr;                       ///< Root of the tree
+    size_t m_stamp = 0;                           ///< Current reduction
+};
+
+
+/**
+  @brief Test the consecutive ones property of a sparse matrix with a PQ-tree.
+
+  Each row is the list of the columns holding a one; the test looks for a
+  permutation of the columns such that the ones of every row are consecutive.
+  Runs in O(rows + cols + ones).
+
+  @param[in]  cols  Number of columns
+  @param[in]  rows  Rows of the matrix, as lists of column indices
+  @param[out] order Column permutation, filled only if the property holds
+
+  @return True if the matrix has the consecutive ones property
+*/
+bool pq_consecutive_ones(size_t cols, const std::vector<std::vector<size_t>> &rows,
+                         std::vector<size_t> &order);
+
+#endif  // PQTREE_HPP
@@ -0,0 +1,577 @@
+/**
+ *
+ * @file preprocess.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "preprocess.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+/**
+  @brief Return true if the words of \e a masked by \e mask are all zeros.
+*/
+bool is_zero(const uint64_t *a, const std::vector<uint64_t> &mask) {
+    for (size_t w = 0; w < mask.size(); ++w)
+        if (a[w] & mask[w])
+            return false;
+    return true;
+}
+
+
+/**
+  @brief Return true if the words of \e a cover all the bits of \e mask .
+*/
+bool covers(const uint64_t *a, const std::vector<uint64_t> &mask) {
+    for (size_t w = 0; w < mask.size(); ++w)
+        if ((a[w] & mask[w]) != mask[w])
+            return false;
+    return true;
+}
+
+
+/**
+  @brief Return the words of \e a masked by \e mask, as a string usable as key.
+*/
+std::string masked_key(const uint64_t *a, const std::vector<uint64_t> &mask) {
+    std::string key(mask.size() * sizeof(uint64_t), '\0');
+    for (size_t w = 0; w < mask.size(); ++w) {
+        const uint64_t word = a[w] & mask[w];
+        for (size_t b = 0; b < sizeof(uint64_t); ++b)
+            key[w * sizeof(uint64_t) + b] = static_cast<char>(word >> (8 * b));
+    }
+    return key;
+}
+
+
+/**
+  @brief Clear bit \e i of the bitset \e mask .
+*/
+inline void clear_bit(std::vector<uint64_t> &mask, const size_t i) {
+    mask[i / 64] &= ~(uint64_t(1) << (i % 64));
+}
+
+
+/**
+  @brief Return bit \e i of the bitset \e mask .
+*/
+inline bool test_bit(const std::vector<uint64_t> &mask, const size_t i) {
+    return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+
+/**
+  @brief Return a bitset of \e n bits, all set.
+*/
+std::vector<uint64_t> full_mask(const size_t n) {
+    std::vector<uint64_t> mask((n + 63) / 64, ~uint64_t(0));
+    if (n % 64 != 0)
+        mask.back() = (uint64_t(1) << (n % 64)) - 1;
+    return mask;
+}
+
+
+/**
+  @brief Sort the columns of \e m by decreasing number of ones with a counting
+  sort, stable on the column order.
+
+  @param[in]  m     Binary matrix
+  @param[out] ones  Number of ones of each column
+  @param[out] order Columns, sorted
+*/
+void sort_columns(const BinaryMatrix &m, std::vector<size_t> &ones, std::vector<size_t> &order) {
+    ones.assign(m.num_cols, 0);
+    for (size_t j = 0; j < m.num_cols; ++j)
+        for (size_t w = 0; w < m.col_words(); ++w)
+            ones[j] += __builtin_popcountll(m.cols[j * m.col_words() + w]);
+
+    std::vector<size_t> start(m.num_rows + 2, 0);
+    for (size_t j = 0; j < m.num_cols; ++j)
+        ++start[m.num_rows - ones[j] + 1];
+    for (size_t k = 1; k < start.size(); ++k)
+        start[k] += start[k - 1];
+
+    order.resize(m.num_cols);
+    for (size_t j = 0; j < m.num_cols; ++j)
+        order[start[m.num_rows - ones[j]]++] = j;
+}
+
+}  // namespace
+
+
+void BinaryMatrix::resize(const size_t r, const size_t c) {
+    num_rows = r;
+    num_cols = c;
+    rows.assign(num_rows * row_words(), 0);
+    cols.assign(num_cols * col_words(), 0);
+}
+
+
+void BinaryMatrix::clear() {
+    num_rows = 0;
+    num_cols = 0;
+    rows.clear();
+    cols.clear();
+    active.clear();
+    row_ids.clear();
+    col_ids.clear();
+}
+
+
+void BinaryMatrix::set(const size_t i, const size_t j) {
+    rows[i * row_words() + j / 64] |= uint64_t(1) << (j % 64);
+    cols[j * col_words() + i / 64] |= uint64_t(1) << (i % 64);
+}
+
+
+void read_matrix(const std::string &filename, BinaryMatrix &m) {
+    std::ifstream file(filename);
+
+    if (!file) {
+        // input file doesn't exist
+        throw std::runtime_error(
+                "[ERROR] Failed to read graph from file: no such file or directory");
+    }
+
+    read_matrix(file, m);
+}
+
+
+void read_matrix(std::istream &is, BinaryMatrix &m) {
+    bool first_line = true;
+    std::string line;
+
+    m.clear();
+
+    size_t index = 0;
+    while (std::getline(is, line)) {
+
+        // for each line in is
+        std::istringstream iss(line);
+
+        if (first_line) {
+            size_t cont = 0;
+            size_t read;
+            size_t num_s = 0, num_c = 0;
+
+            while (iss >> read) {
+                if (cont == 0) {
+                    num_s = read;
+                    cont++;
+                } else if (cont == 1) {
+                    num_c = read;
+                    cont++;
+                } else {
+                    if (read >= num_c) {
+                        throw std::runtime_error("[ERROR] Failed to read graph from file: Inexistent character");
+                    }
+                    m.active.push_back(read);
+                }
+            }
+
+            if (num_s == 0 || num_c == 0) {
+                // input file parsing error
+                throw std::runtime_error(
+                        "[ERROR] Failed to read graph from file: badly formatted line 0");
+            }
+
+            m.resize(num_s, num_c);
+            for (size_t i = 0; i < num_s; ++i)
+                m.row_ids.push_back(i);
+            for (size_t j = 0; j < num_c; ++j)
+                m.col_ids.push_back(j);
+
+            first_line = false;
+        } else {
+            char value;
+
+            // read binary matrix
+            while (iss >> value) {
+                switch (value) {
+                    case '1': {
+                        const auto s_index = index / m.num_cols,
+                                c_index = index % m.num_cols;
+
+                        if (s_index >= m.num_rows) {
+                            // input file parsing error
+                                throw std::runtime_error(
+                                    "[ERROR] Failed to read graph from file: oversized matrix");
+                        }
+
+                        m.set(s_index, c_index);
+                    }
+                        break;
+
+                    case '0':
+                        // ignore
+                        break;
+
+                    default:
+                        // input file parsing error
+                        throw std::runtime_error(
+                                "[ERROR] Failed to read graph from file: unexpected value in matrix");
+                }
+
+                index++;
+            }
+        }
+    }
+
+    if (index != m.num_rows * m.num_cols) {
+        // input file parsing error
+        throw std::runtime_error(
+                "[ERROR] Failed to read graph from file: undersized matrix");
+    }
+
+    if (m.num_rows == 0 || m.num_cols == 0) {
+        // input file parsing error
+        throw std::runtime_error("[ERROR] Failed to read graph from file: empty file");
+    }
+
+}
+
+
+void read_binary_matrix(std::istream &is, BinaryMatrix &m) {
+    auto read_uint32 = [&is]() {
+        unsigned char bytes[4];
+        if (!is.read(reinterpret_cast<char *>(bytes), sizeof(bytes))) {
+            throw std::runtime_error(
+                    "[ERROR] Failed to read binary matrix: truncated header");
+        }
+
+        return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 |
+               uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+    };
+
+    char magic[4];
+    if (!is.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != "PPPB") {
+        throw std::runtime_error(
+                "[ERROR] Failed to read binary matrix: bad magic number");
+    }
+
+    m.clear();
+
+    const size_t num_s = read_uint32(), num_c = read_uint32(), num_a = read_uint32();
+    if (num_s == 0 || num_c == 0) {
+        throw std::runtime_error("[ERROR] Failed to read binary matrix: empty matrix");
+    }
+
+    for (size_t k = 0; k < num_a; ++k) {
+        const size_t j = read_uint32();
+        if (j >= num_c) {
+            throw std::runtime_error(
+                    "[ERROR] Failed to read binary matrix: Inexistent character");
+        }
+        m.active.push_back(j);
+    }
+
+    m.resize(num_s, num_c);
+    for (size_t i = 0; i < num_s; ++i)
+        m.row_ids.push_back(i);
+    for (size_t j = 0; j < num_c; ++j)
+        m.col_ids.push_back(j);
+
+    std::vector<unsigned char> row((num_c + 7) / 8);
+    for (size_t i = 0; i < num_s; ++i) {
+        if (!is.read(reinterpret_cast<char *>(row.data()), row.size())) {
+            throw std::runtime_error(
+                    "[ERROR] Failed to read binary matrix: undersized matrix");
+        }
+
+        for (size_t j = 0; j < num_c; ++j)
+            if ((row[j / 8] >> (j % 8)) & 1)
+                m.set(i, j);
+    }
+}
+
+
+void build_graph(const BinaryMatrix &m, RBGraph &g) {
+    std::vector<RBVertex> species(m.num_rows), characters(m.num_cols);
+
+    // insert species in the graph
+    for (size_t i = 0; i < m.num_rows; ++i)
+        species[i] = add_species("s" + std::to_string(m.row_ids[i]), g);
+
+    // insert characters in the graph
+    for (size_t j = 0; j < m.num_cols; ++j)
+        characters[j] = add_character("c" + std::to_string(m.col_ids[j]), g);
+
+    // add an edge for each one in the matrix
+    for (size_t i = 0; i < m.num_rows; ++i)
+        for (size_t j = 0; j < m.num_cols; ++j)
+            if (m.get(i, j))
+                add_edge(species[i], characters[j], g);
+
+    for (size_t j : m.active)
+        change_char_type(characters[j], g);
+}
+
+
+void reduce_matrix(BinaryMatrix &m, MatrixReduction &r) {
+    BinaryMatrix scratch;
+    reduce_matrix(m, r, scratch);
+}
+
+
+void reduce_matrix(BinaryMatrix &m, MatrixReduction &r, BinaryMatrix &scratch) {
+    r.realized.clear();
+    r.twins.clear();
+
+    auto char_name = [&m](const size_t j) { return "c" + std::to_string(m.col_ids[j]); };
+
+    // row_mask and col_mask are the rows and columns still in the matrix,
+    // active_mask the active columns (duplicate entries in m.active count once)
+    std::vector<uint64_t> row_mask = full_mask(m.num_rows), col_mask = full_mask(m.num_cols);
+    std::vector<uint64_t> active_mask(m.row_words(), 0), inactive_mask = col_mask;
+    for (size_t j : m.active) {
+        active_mask[j / 64] |= uint64_t(1) << (j % 64);
+        clear_bit(inactive_mask, j);
+    }
+
+    std::vector<uint64_t> live_active(active_mask.size()), live_inactive(inactive_mask.size());
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t w = 0; w < col_mask.size(); ++w) {
+            live_active[w] = active_mask[w] & col_mask[w];
+            live_inactive[w] = inactive_mask[w] & col_mask[w];
+        }
+
+        // species with no black edge and no red edge
+        for (size_t i = 0; i < m.num_rows; ++i) {
+            if (!test_bit(row_mask, i))
+                continue;
+
+            const uint64_t *row = &m.rows[i * m.row_words()];
+            if (is_zero(row, live_inactive) && covers(row, live_active)) {
+                clear_bit(row_mask, i);
+                changed = true;
+            }
+        }
+
+        // characters with no edge, universal and red-universal characters
+        for (size_t j = 0; j < m.num_cols; ++j) {
+            if (!test_bit(col_mask, j))
+                continue;
+
+            const uint64_t *col = &m.cols[j * m.col_words()];
+            const bool active = test_bit(active_mask, j);
+            const bool none = is_zero(col, row_mask), all = covers(col, row_mask);
+
+            if (!is_zero(row_mask.data(), row_mask)) {
+                if (!active && all)
+                    r.realized.push_back({char_name(j), State::gain});
+                else if (active && none)
+                    r.realized.push_back({char_name(j), State::lose});
+                else if (!(active ? all : none))
+                    continue;
+            }
+
+            clear_bit(col_mask, j);
+            changed = true;
+        }
+    }
+
+    // collapse duplicate characters into the first one
+    std::unordered_map<std::string, size_t> first_col;
+    for (size_t j = 0; j < m.num_cols; ++j) {
+        if (!test_bit(col_mask, j))
+            continue;
+
+        const std::string key = masked_key(&m.cols[j * m.col_words()], row_mask) +
+                                (test_bit(active_mask, j) ? '+' : '-');
+        const auto first = first_col.emplace(key, j);
+        if (!first.second) {
+            r.twins[char_name(first.first->second)].push_back(char_name(j));
+            clear_bit(col_mask, j);
+        }
+    }
+
+    // collapse duplicate species into the first one
+    std::unordered_map<std::string, size_t> first_row;
+    for (size_t i = 0; i < m.num_rows; ++i) {
+        if (!test_bit(row_mask, i))
+            continue;
+
+        if (!first_row.emplace(masked_key(&m.rows[i * m.row_words()], col_mask), i).second)
+            clear_bit(row_mask, i);
+    }
+
+    // build the reduced matrix in scratch
+    BinaryMatrix &reduced = scratch;
+    reduced.clear();
+    std::vector<size_t> new_col(m.num_cols, 0);
+    size_t num_rows = 0, num_cols = 0;
+    for (size_t i = 0; i < m.num_rows; ++i)
+        num_rows += test_bit(row_mask, i);
+    for (size_t j = 0; j < m.num_cols; ++j)
+        if (test_bit(col_mask, j))
+            new_col[j] = num_cols++;
+
+    reduced.resize(num_rows, num_cols);
+    for (size_t j = 0; j < m.num_cols; ++j)
+        if (test_bit(col_mask, j))
+            reduced.col_ids.push_back(m.col_ids[j]);
+
+    for (size_t j : m.active) {
+        if (test_bit(col_mask, j) &&
+            std::find(reduced.active.begin(), reduced.active.end(), new_col[j]) == reduced.active.end())
+            reduced.active.push_back(new_col[j]);
+    }
+
+    for (size_t i = 0; i < m.num_rows; ++i) {
+        if (!test_bit(row_mask, i))
+            continue;
+
+        const size_t new_row = reduced.row_ids.size();
+        reduced.row_ids.push_back(m.row_ids[i]);
+        for (size_t j = 0; j < m.num_cols; ++j)
+            if (test_bit(col_mask, j) && m.get(i, j))
+                reduced.set(new_row, new_col[j]);
+    }
+
+    std::swap(m, reduced);
+}
+
+
+bool perfect_phylogeny(const BinaryMatrix &m, std::list<SignedCharacter> &realized) {
+    realized.clear();
+
+    if (!m.active.empty())
+        return false;
+
+    std::vector<size_t> ones, order;
+    sort_columns(m, ones, order);
+
+    // last[j] is the last column with a one before j in the rows with a one in j
+    const size_t none = m.num_cols, unset = m.num_cols + 1;
+    std::vector<size_t> last(m.num_cols, unset);
+    for (size_t i = 0; i < m.num_rows; ++i) {
+        size_t previous = none;
+        for (const size_t j : order) {
+            if (!m.get(i, j))
+                continue;
+
+            if (last[j] == unset)
+                last[j] = previous;
+            else if (last[j] != previous)
+                // j conflicts with previous or with last[j]
+                return false;
+
+            previous = j;
+        }
+    }
+
+    // the columns with no column before them are the maximal characters, in
+    // the order of maximal_characters
+    for (const size_t j : order)
+        if (last[j] == none)
+            realized.push_back({"c" + std::to_string(m.col_ids[j]), State::gain});
+
+    return true;
+}
+
+
+std::vector<std::vector<size_t>> conflict_components(const BinaryMatrix &m) {
+    std::vector<size_t> ones, order;
+    sort_columns(m, ones, order);
+
+    const size_t words = m.col_words();
+    auto column = [&m, words](const size_t j) { return &m.cols[j * words]; };
+
+    std::vector<bool> active(m.num_cols, false);
+    for (const size_t j : m.active)
+        active[j] = true;
+
+    // a column is maximal if no column before it in order includes it
+    std::vector<size_t> maximal;
+    for (const size_t j : order) {
+        if (ones[j] == 0)
+            break;
+
+        if (active[j])
+            continue;
+
+        bool included = false;
+        for (const size_t k : maximal) {
+            const uint64_t *a = column(j), *b = column(k);
+            included = true;
+            for (size_t w = 0; w < words && included; ++w)
+                included = ((a[w] & ~b[w]) == 0);
+
+            if (included)
+                break;
+        }
+
+        if (!included)
+            maximal.push_back(j);
+    }
+
+    // union-find on the positions in maximal, joined by the conflicting pairs
+    std::vector<size_t> parent(maximal.size());
+    for (size_t x = 0; x < parent.size(); ++x)
+        parent[x] = x;
+
+    auto find = [&parent](size_t x) {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    };
+
+    for (size_t x = 0; x < maximal.size(); ++x) {
+        for (size_t y = x + 1; y < maximal.size(); ++y) {
+            // gametes (1, 1), (1, 0) and (0, 1); (0, 0) is the root
+            const uint64_t *a = column(maximal[x]), *b = column(maximal[y]);
+            uint64_t both = 0, only_a = 0, only_b = 0;
+            for (size_t w = 0; w < words; ++w) {
+                both |= a[w] & b[w];
+                only_a |= a[w] & ~b[w];
+                only_b |= ~a[w] & b[w];
+            }
+
+            if (both && only_a && only_b)
+                parent[find(x)] = find(y);
+        }
+    }
+
+    std::vector<std::vector<size_t>> components;
+    std::vector<size_t> component_of(maximal.size(), maximal.size());
+    for (size_t x = 0; x < maximal.size(); ++x) {
+        size_t &c = component_of[find(x)];
+        if (c == maximal.size()) {
+            c = components.size();
+            components.emplace_back();
+        }
+
+        components[c].push_back(maximal[x]);
+    }
+
+    return components;
+}
+
+
+std::list<SignedCharacter> expand_realized(const std::list<SignedCharacter> &lsc,
+                                           const MatrixReduction &r) {
+    std::list<SignedCharacter> output = r.realized;
+
+    for (const SignedCharacter &sc : lsc) {
+        output.push_back(sc);
+
+        const auto twins = r.twins.find(sc.character);
+        if (twins == r.twins.end())
+            continue;
+
+        for (const std::string &twin : twins->second)
+            output.push_back({twin, sc.state});
+    }
+
+    return output;
+}
@@ -0,0 +1,230 @@
+/**
+ *
+ * @file preprocess.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef PREPROCESS_HPP
+#define PREPROCESS_HPP
+
+#include <cstdint>
+#include "functions.hpp"
+
+//=============================================================================
+// Data structures
+
+
+/**
+  @brief Struct used to represent a binary matrix read from a file
+
+  The matrix is stored twice as bitsets, by rows and by columns, so that both
+  rows and columns can be compared a word at a time.
+*/
+struct BinaryMatrix {
+    size_t num_rows{};  ///< Number of rows (species)
+    size_t num_cols{};  ///< Number of columns (characters)
+
+    std::vector<uint64_t> rows{};  ///< Bitset of each row, row_words() words per row
+    std::vector<uint64_t> cols{};  ///< Bitset of each column, col_words() words per column
+
+    std::vector<size_t> active{};  ///< Active columns, in the order given in the file
+
+    std::vector<size_t> row_ids{};  ///< Species index of each row (s0, s1, ...)
+    std::vector<size_t> col_ids{};  ///< Character index of each column (c0, c1, ...)
+
+    /**
+      @brief Return the number of words of the bitset of a row.
+    */
+    size_t row_words() const { return (num_cols + 63) / 64; }
+
+    /**
+      @brief Return the number of words of the bitset of a column.
+    */
+    size_t col_words() const { return (num_rows + 63) / 64; }
+
+    /**
+      @brief Return the value in row \e i and column \e j .
+    */
+    bool get(const size_t i, const size_t j) const {
+        return (rows[i * row_words() + j / 64] >> (j % 64)) & 1;
+    }
+
+    /**
+      @brief Resize the matrix to \e r rows and \e c columns, all zeros.
+    */
+    void resize(size_t r, size_t c);
+
+    /**
+      @brief Empty the matrix, keeping the capacity of its buffers.
+    */
+    void clear();
+
+    /**
+      @brief Set to 1 the value in row \e i and column \e j .
+    */
+    void set(size_t i, size_t j);
+};
+
+
+/**
+  @brief Struct used to map the characters of a reduced matrix back to the
+  characters of the original matrix
+*/
+struct MatrixReduction {
+    std::list<SignedCharacter> realized{};  ///< Characters realized by the reduction
+
+    std::map<std::string, std::list<std::string>> twins{};  ///< Characters removed as
+    ///< duplicates of each character of the reduced matrix
+};
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Read the matrix in \e filename into \e m .
+
+  The file format is the one read by read_graph.
+
+  @param[in]  filename Filename
+  @param[out] m        Binary matrix
+*/
+void read_matrix(const std::string &filename, BinaryMatrix &m);
+
+
+/**
+  @brief Read the matrix in the stream \e is into \e m .
+
+  The format is the one read by read_graph.
+
+  @param[in]  is Input stream
+  @param[out] m  Binary matrix
+*/
+void read_matrix(std::istream &is, BinaryMatrix &m);
+
+
+/**
+  @brief Read the matrix in binary format in the stream \e is into \e m .
+
+  The binary format is made of the 4 bytes "PPPB", the number of species, the
+  number of characters, the number of active characters and the index of each
+  active character, as 32-bit little-endian integers, then each row of the
+  matrix as a bitset of (characters + 7) / 8 bytes, where character j is the
+  bit j % 8 of the byte j / 8.
+
+  @param[in]  is Input stream
+  @param[out] m  Binary matrix
+*/
+void read_binary_matrix(std::istream &is, BinaryMatrix &m);
+
+
+/**
+  @brief Add the red-black graph of the matrix \e m to \e g .
+
+  Row i is the species s<m.row_ids[i]> and column j is the character
+  c<m.col_ids[j]>; the active characters are then made active.
+
+  @param[in]  m Binary matrix
+  @param[out] g Red-black graph
+*/
+void build_graph(const BinaryMatrix &m, RBGraph &g);
+
+
+/**
+  @brief Reduce the matrix \e m before building its red-black graph.
+
+  Until nothing changes, the reduction removes:
+  - the species with no edge in the red-black graph (no inactive characters
+    and every active character);
+  - the characters with no edge in the red-black graph;
+  - the universal characters, which are realized (c+ if inactive, c- if
+    active and red-universal).
+
+  Then duplicate characters (same column and state) are collapsed into the
+  first one, and duplicate species into the first one. Every step works on
+  whole words of the row and column bitsets, in O(nm / 64) per pass.
+
+  The rows and columns of \e m keep their original species and character
+  indices, so the reduced graph uses the original names.
+
+  @param[in,out] m Binary matrix
+  @param[out]    r Reduction mapping
+*/
+void reduce_matrix(BinaryMatrix &m, MatrixReduction &r);
+
+
+/**
+  @brief Reduce the matrix \e m as reduce_matrix(m, r), building the reduced
+  matrix in the buffers of \e scratch .
+
+  The buffers of \e m and \e scratch are swapped, so that a caller reducing
+  many matrices reuses the same two sets of buffers.
+
+  @param[in,out] m       Binary matrix
+  @param[out]    r       Reduction mapping
+  @param[in,out] scratch Binary matrix used as buffer (its content is lost)
+*/
+void reduce_matrix(BinaryMatrix &m, MatrixReduction &r, BinaryMatrix &scratch);
+
+
+/**
+  @brief Solve the matrix \e m in O(nm) time if it has a perfect phylogeny.
+
+  The test is the one of Gusfield's perfect phylogeny algorithm: the columns
+  are sorted by decreasing number of ones (a counting sort, stable on the
+  column order), and \e m has a perfect phylogeny if and only if, for each
+  column j, the rows with a one in j have the same last column with a one
+  before j in that order. It is applied only if \e m has no active
+  characters.
+
+  On success, \e realized holds the characters realized by the PPP algorithm
+  on the maximal reducible graph of \e m: the gain of each maximal character,
+  the first of identical columns, by decreasing number of ones and then in
+  the order of the columns.
+
+  @param[in]  m        Binary matrix
+  @param[out] realized Realized characters
+
+  @return True if \e m has no active characters and no pair of conflicting
+  characters
+*/
+bool perfect_phylogeny(const BinaryMatrix &m, std::list<SignedCharacter> &realized);
+
+
+/**
+  @brief Return the conflict components of the maximal characters of \e m .
+
+  The maximal characters are the ones of maximal_reducible_graph, in the same
+  order: the nonempty columns not included in another column (the first of
+  identical columns), by decreasing number of ones and then in the order of
+  the columns. Two of them conflict if some rows have ones in both, in the
+  first only and in the second only, which is tested a word at a time; the
+  active characters are ignored. Maximal characters that do not conflict
+  have no rows in common, so each component is a connected component of the
+  maximal reducible graph.
+
+  @param[in] m Binary matrix
+
+  @return Columns of each component, in the order of the maximal characters;
+  the components are sorted by their first column in that order
+*/
+std::vector<std::vector<size_t>> conflict_components(const BinaryMatrix &m);
+
+
+/**
+  @brief Map the characters realized on a reduced matrix to the original one.
+
+  The characters realized by the reduction come first, then each signed
+  character of \e lsc is followed by the same sign of its duplicates.
+
+  @param[in] lsc Signed characters realized on the reduced matrix
+  @param[in] r   Reduction mapping
+
+  @return Signed characters of the original matrix
+*/
+std::list<SignedCharacter> expand_realized(const std::list<SignedCharacter> &lsc,
+                                           const MatrixReduction &r);
+
+#endif  // PREPROCESS_HPP
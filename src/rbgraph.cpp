@@ -12,19 +12,38 @@
 #include <boost/graph/copy.hpp>
 #include <boost/graph/graph_utility.hpp>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <set>
 #include <stdio.h>
+#include <unordered_map>
+#include <unordered_set>
 #include "functions.hpp"
 #include "LexBFS-master/src/SparseMatrix.h"
+#include "pqtree.hpp"
+#include "preprocess.hpp"
+
+size_t new_version() {
+    static std::atomic<size_t> last_version{0};
+
+    return ++last_version;
+}
 
 //=============================================================================
 // Boost functions (overloading)
 
 void clear(RBGraph &g) {
+    if (MaximalCharacterIndex *index = get_maximal_index(g))
+        index->invalidate();
+    if (Worklists *worklists = get_worklists(g))
+        worklists->invalidate();
+
     g.clear();
     vertex_map(g).clear();
     num_characters(g) = 0;
     num_species(g) = 0;
+    bump_version(g);
 }
 
 void remove_edge(const RBVertex &s, const RBVertex &t, RBGraph &g) {
@@ -33,7 +52,20 @@ void remove_edge(const RBVertex &s, const RBVertex &t, RBGraph &g) {
     if (!exists(s, t, g))
         throw std::runtime_error("[ERROR] In remove_edge(): edge does not exist");
 
+    if (MaximalCharacterIndex *index = get_maximal_index(g)) {
+        if (is_species(s, g))
+            index->remove_edge(s, t);
+        else
+            index->remove_edge(t, s);
+    }
+
+    if (Worklists *worklists = get_worklists(g)) {
+        worklists->touch(s);
+        worklists->touch(t);
+    }
+
     boost::remove_edge(s, t, g);
+    bump_version(g);
 }
 
 
@@ -46,13 +78,30 @@ void remove_vertex(const RBVertex &v, RBGraph &g) {
     if (!exists(v, g))
         throw std::runtime_error("[ERROR] In remove_vertex(): vertex does not exist");
 
+    if (MaximalCharacterIndex *index = get_maximal_index(g)) {
+        if (is_species(v, g))
+            index->remove_species(v);
+        else
+            index->remove_character(v);
+    }
+
+    if (Worklists *worklists = get_worklists(g)) {
+        for (RBVertex u : get_adj_vertices(v, g))
+            worklists->touch(u);
+        worklists->remove_vertex(v);
+    }
+
+    // the type of v is read before v is freed
+    const bool species = is_species(v, g);
+
     // delete v from the map
     vertex_map(g).erase(g[v].name);
 
     boost::clear_vertex(v, g);
     boost::remove_vertex(v, g);
+    bump_version(g);
 
-    if (is_species(v, g))
+    if (species)
         num_species(g)--;
     else
         num_characters(g)--;
@@ -60,7 +109,22 @@ void remove_vertex(const RBVertex &v, RBGraph &g) {
 
 
 void remove_vertex(const std::string &name, RBGraph &g) {
-    remove_vertex(get_vertex(name, g), g);
+    // copy of the vertex, since the reference returned by get_vertex is
+    // freed with the entry of name in the vertex map
+    const RBVertex v = get_vertex(name, g);
+    remove_vertex(v, g);
+}
+
+
+void clear_vertex(const RBVertex &v, RBGraph &g) {
+    if (Worklists *worklists = get_worklists(g)) {
+        worklists->touch(v);
+        for (RBVertex u : get_adj_vertices(v, g))
+            worklists->touch(u);
+    }
+
+    boost::clear_vertex(v, g);
+    bump_version(g);
 }
 
 
@@ -79,6 +143,10 @@ RBVertex add_vertex(const std::string &name, const Type type, RBGraph &g) {
 
     g[v].name = name;
     g[v].type = type;
+    bump_version(g);
+
+    if (Worklists *worklists = get_worklists(g))
+        worklists->add_vertex(v);
 
     if (is_species(v, g))
         num_species(g)++;
@@ -103,6 +171,19 @@ std::pair<RBEdge, bool> add_edge(const RBVertex &u, const RBVertex &v, const Col
     bool exists;
     std::tie(e, exists) = boost::add_edge(u, v, g);
     g[e].color = color;
+    bump_version(g);
+
+    if (Worklists *worklists = get_worklists(g)) {
+        worklists->touch(u);
+        worklists->touch(v);
+    }
+
+    if (MaximalCharacterIndex *index = get_maximal_index(g)) {
+        if (is_species(u, g))
+            index->add_edge(u, v, color);
+        else
+            index->add_edge(v, u, color);
+    }
 
     return std::make_pair(e, exists);
 }
@@ -194,6 +275,11 @@ void remove_singletons(RBGraph &g) {
 
 
 void copy_graph(const RBGraph &g, RBGraph &g_copy) {
+    if (MaximalCharacterIndex *index = get_maximal_index(g_copy))
+        index->invalidate();
+    if (Worklists *worklists = get_worklists(g_copy))
+        worklists->invalidate();
+
     RBVertexIMap index_map;
     RBVertexIAssocMap index_assocmap(index_map);
 
@@ -206,6 +292,7 @@ void copy_graph(const RBGraph &g, RBGraph &g_copy) {
 
     // copy g to g_copy
     copy_graph(g, g_copy, boost::vertex_index_map(index_assocmap));
+    bump_version(g_copy);
 
     // update g_copy's number of species and characters
     num_species(g_copy) = num_species(g);
@@ -217,6 +304,11 @@ void copy_graph(const RBGraph &g, RBGraph &g_copy) {
 
 
 void copy_graph(const RBGraph &g, RBGraph &g_copy, RBVertexMap &v_map) {
+    if (MaximalCharacterIndex *index = get_maximal_index(g_copy))
+        index->invalidate();
+    if (Worklists *worklists = get_worklists(g_copy))
+        worklists->invalidate();
+
     RBVertexIMap index_map;
     RBVertexAssocMap v_assocmap(v_map);
     RBVertexIAssocMap index_assocmap(index_map);
@@ -231,6 +323,7 @@ void copy_graph(const RBGraph &g, RBGraph &g_copy, RBVertexMap &v_map) {
     // copy g to g_copy, fill the vertex map v_assocmap (and v_map)
     copy_graph(g, g_copy,
                boost::vertex_index_map(index_assocmap).orig_to_copy(v_assocmap));
+    bump_version(g_copy);
 
     // update g_copy's number of species and characters
     num_species(g_copy) = num_species(g);
@@ -328,44 +421,87 @@ std::ostream &operator<<(std::ostream &os, const RBGraph &g) {
 }
 
 
-bool has_consecutive_ones_property(RBGraph &g) {
+bool has_consecutive_ones_property(RBGraph &g, const C1PEngine engine) {
+    std::list<RBVertex> order;
 
-    // prepare the input for the external library by Hackob
-    size_t rows = g[boost::graph_bundle].num_species;
-    size_t cols = g[boost::graph_bundle].num_characters;
-    bool **m = new bool *[rows];
-    for (int i = 0; i < rows; ++i) {
-        m[i] = new bool[cols];
-    }
-    get_matrix_representation(g, m, rows, cols);
+    return has_consecutive_ones_property(g, order, engine);
+}
 
-    // prepare input for external
-    bool *reshaped_m = new bool[rows * cols];
-    int k = 0;
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j) {
-            reshaped_m[k] = m[i][j];
-            ++k;
-        }
 
-    SparseMatrix prepared_input(reshaped_m, rows, cols);
+bool has_consecutive_ones_property(RBGraph &g, std::list<RBVertex> &order,
+                                   const C1PEngine engine) {
+    order.clear();
+
+    std::vector<RBVertex> characters;
+    std::vector<std::vector<size_t>> rows;
+    get_sparse_representation(g, characters, rows);
 
-    bool has_01_propertry = prepared_input.hasConsecutiveOnesProperty();
+    if (engine == C1PEngine::pqtree) {
+        std::vector<size_t> columns;
+        if (!pq_consecutive_ones(characters.size(), rows, columns))
+            return false;
+
+        for (size_t i : columns)
+            order.push_back(characters[i]);
+
+        return true;
+    }
+
+    // prepare the input for the external library by Hackob: the list of the
+    // species of each column, in ascending order
+    std::vector<std::vector<unsigned int>> cliques(characters.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (size_t j : rows[i])
+            cliques[j].push_back(i);
+    }
 
+    SparseMatrix prepared_input(cliques, rows.size());
 
-    // free memory allocated for reshaped_m
-    delete[] reshaped_m;
+    std::vector<int> columns;
+    bool has_01_propertry = prepared_input.hasConsecutiveOnesProperty(columns);
 
-    // free memory allocated for m
-    for (int i = 0; i < rows; ++i) {
-        delete[] m[i];
+    if (has_01_propertry) {
+        for (int i : columns)
+            order.push_back(characters[i]);
     }
-    delete[] m;
 
     return has_01_propertry;
 }
 
 
+void get_sparse_representation(const RBGraph &g, std::vector<RBVertex> &characters,
+                               std::vector<std::vector<size_t>> &rows) {
+    characters.clear();
+    rows.clear();
+
+    // mapping[v] will contain the column index of character v, in the same
+    // order used by get_matrix_representation
+    std::unordered_map<RBVertex, size_t> mapping;
+    characters.reserve(num_characters(g));
+    for (RBVertex v : g.m_vertices) {
+        if (is_character(v, g)) {
+            mapping[v] = characters.size();
+            characters.push_back(v);
+        }
+    }
+
+    // the row of each species lists the columns of its inactive characters
+    rows.reserve(num_species(g));
+    for (RBVertex v : g.m_vertices) {
+        if (!is_species(v, g))
+            continue;
+
+        rows.emplace_back();
+        RBOutEdgeIter e, e_end;
+        std::tie(e, e_end) = out_edges(v, g);
+        for (; e != e_end; ++e) {
+            if (g[*e].color == Color::black)
+                rows.back().push_back(mapping.at(e->m_target));
+        }
+    }
+}
+
+
 void get_matrix_representation(const RBGraph &g, bool **m, size_t rows, size_t cols) {
 
     // mapping is a helper data structure used to encode the mapping between
@@ -408,128 +544,18 @@ void get_matrix_representation(const RBGraph &g, bool **m, size_t rows, size_t c
 
 
 void read_graph(const std::string &filename, RBGraph &g) {
-    std::vector<RBVertex> species, characters;
-    bool first_line = true;
-    std::string line;
-    std::ifstream file(filename);
-    std::vector<std::string> a_chars;
-
-    if (!file) {
-        // input file doesn't exist
-        throw std::runtime_error(
-                "[ERROR] Failed to read graph from file: no such file or directory");
-    }
-
-    size_t index = 0;
-    while (std::getline(file, line)) {
-
-        // for each line in file
-        std::istringstream iss(line);
-
-        if (first_line) {
-            size_t cont = 0;
-            size_t read;
-            size_t num_s, num_c;
-
-            while (iss >> read) {
-                if (cont == 0) {
-                    num_s = read;
-                    cont++;
-                } else if (cont == 1) {
-                    num_c = read;
-                    cont++;
-                } else {
-                    if (read >= num_c) {
-                        file.close();
-                        throw std::runtime_error("[ERROR] Failed to read graph from file: Inexistent character");
-                    }
-                    std::string s = "c" + std::to_string(read);
-                    a_chars.push_back(s);
-                }
-            }
-
-            species.resize(num_s);
-            characters.resize(num_c);
-
-            if (species.size() == 0 || characters.size() == 0) {
-                // input file parsing error
-                file.close();
-                throw std::runtime_error(
-                        "[ERROR] Failed to read graph from file: badly formatted line 0");
-            }
-
-            // insert species in the graph
-            for (size_t j = 0; j < species.size(); ++j) {
-                const auto v_name = "s" + std::to_string(j);
-
-                species[j] = add_species(v_name, g);
-            }
+    BinaryMatrix m;
 
-            // insert characters in the graph
-            for (size_t j = 0; j < characters.size(); ++j) {
-                const auto v_name = "c" + std::to_string(j);
-
-                characters[j] = add_character(v_name, g);
-            }
-
-            first_line = false;
-        } else {
-            char value;
-
-            // read binary matrix
-            while (iss >> value) {
-                switch (value) {
-                    case '1':
-                        // add edge between species[s_index] and characters[c_index]
-                    {
-                        const auto s_index = index / characters.size(),
-                                c_index = index % characters.size();
-
-                        if (s_index >= species.size() || c_index >= characters.size()) {
-                            // input file parsing error
-                            file.close();
-                            throw std::runtime_error(
-                                    "[ERROR] Failed to read graph from file: oversized matrix");
-                        }
-
-                        add_edge(species[s_index], characters[c_index], g);
-                    }
-                        break;
-
-                    case '0':
-                        // ignore
-                        break;
-
-                    default:
-                        // input file parsing error
-                        file.close();
-                        throw std::runtime_error(
-                                "[ERROR] Failed to read graph from file: unexpected value in matrix");
-                }
-
-                index++;
-            }
-        }
-    }
-
-
-    if (index != species.size() * characters.size()) {
-        // input file parsing error
-        file.close();
-        throw std::runtime_error(
-                "[ERROR] Failed to read graph from file: undersized matrix");
-    }
+    read_matrix(filename, m);
+    build_graph(m, g);
+}
 
-    if (species.size() == 0 || characters.size() == 0) {
-        // input file parsing error
-        file.close();
-        throw std::runtime_error("[ERROR] Failed to read graph from file: empty file");
-    }
 
-    for (const auto &elem : a_chars)
-        change_char_type(vertex_map(g).at(elem), g);
+void read_graph(std::istream &is, RBGraph &g) {
+    BinaryMatrix m;
 
-    file.close();
+    read_matrix(is, m);
+    build_graph(m, g);
 }
 
 
@@ -574,6 +600,9 @@ bool is_pending_species(const RBVertex &s, const RBGraph &g) {
 
 
 std::list<RBVertex> get_pending_species(const RBGraph &g) {
+    if (Worklists *worklists = get_worklists(g))
+        return worklists->list(Worklist::pending_species);
+
     std::list<RBVertex> pending_species;
     for (RBVertex v : g.m_vertices)
         if (is_pending_species(v, g))
@@ -598,6 +627,8 @@ void remove_duplicate_species(RBGraph &g) {
 
         if (is_character(*u, g)) continue;
 
+        check_deadline("duplicate species");
+
         RBVertexIter v, v_end, next;
         std::tie(v, v_end) = vertices(g);
         for (next = v; v != v_end; v = next) {
@@ -643,6 +674,10 @@ void remove_duplicate_species(RBGraph &g) {
 
 
 bool all_species_with_red_edges(const RBGraph &g) {
+    if (Worklists *worklists = get_worklists(g))
+        // the species with no red edges are the active ones
+        return (worklists->size(Worklist::active_species) == 0);
+
     for (RBVertex v : g.m_vertices) {
         if (!is_species(v, g)) continue;
         bool has_red_edge = false;
@@ -812,6 +847,61 @@ RBGraphVector connected_components(const RBGraph &g, const RBVertexIMap &c_map,
 }
 
 
+ComponentIndex::ComponentIndex(const RBGraph &g) {
+    id.reserve(num_vertices(g));
+
+    // label the components by a depth-first visit from each vertex not
+    // labelled yet, in vertex order, counting the vertices of each component
+    std::vector<size_t> size;
+    std::vector<RBVertex> stack;
+    for (RBVertex root : g.m_vertices) {
+        if (!id.emplace(root, size.size()).second)
+            continue;
+
+        const size_t c = size.size();
+        size.push_back(0);
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            const RBVertex v = stack.back();
+            stack.pop_back();
+            ++size[c];
+
+            RBOutEdgeIter e, e_end;
+            std::tie(e, e_end) = out_edges(v, g);
+            for (; e != e_end; ++e) {
+                if (id.emplace(e->m_target, c).second)
+                    stack.push_back(e->m_target);
+            }
+        }
+    }
+
+    for (size_t c = 0; c < size.size(); ++c)
+        start.push_back(start.back() + size[c]);
+
+    // place the vertices of each component in the order of the vertex list
+    std::vector<size_t> next(start.begin(), start.end() - 1);
+    order.resize(num_vertices(g));
+    for (RBVertex v : g.m_vertices)
+        order[next[id.at(v)]++] = v;
+}
+
+
+const ComponentIndex &component_index(const RBGraph &g) {
+    thread_local std::unique_ptr<ComponentIndex> index;
+    thread_local const RBGraph *index_graph = nullptr;
+    thread_local size_t index_version = 0;
+
+    if (!index || index_graph != &g || index_version != version(g)) {
+        index = std::make_unique<ComponentIndex>(g);
+        index_graph = &g;
+        index_version = version(g);
+    }
+
+    return *index;
+}
+
+
 std::list<RBVertex> get_neighbors(const RBVertex &v, const RBGraph &g) {
 
     std::set<RBVertex> output;
@@ -954,6 +1044,68 @@ bool overlaps_species(const RBVertex &s1, const RBVertex &s2, const RBGraph &g)
 }
 
 
+std::vector<std::vector<size_t>> overlap_graph(const std::vector<RBVertex> &chars,
+                                               const RBGraph &g) {
+    // species of each character, as bitsets
+    std::unordered_map<RBVertex, size_t> species_bit;
+    for (RBVertex v : g.m_vertices) {
+        if (is_species(v, g)) {
+            const size_t bit = species_bit.size();
+            species_bit[v] = bit;
+        }
+    }
+
+    const size_t words = (species_bit.size() + 63) / 64;
+    std::vector<uint64_t> species(chars.size() * words, 0);
+    std::vector<size_t> size(chars.size(), 0);
+    std::vector<std::vector<size_t>> chars_of(species_bit.size());
+
+    for (size_t i = 0; i < chars.size(); ++i) {
+        for (RBVertex s : get_adj_vertices(chars[i], g)) {
+            const size_t bit = species_bit.at(s);
+            species[i * words + bit / 64] |= uint64_t(1) << (bit % 64);
+            chars_of[bit].push_back(i);
+            ++size[i];
+        }
+    }
+
+    // S(a) ⊆ S(b)
+    auto included = [&](const size_t a, const size_t b) {
+        if (size[a] > size[b])
+            return false;
+
+        for (size_t w = 0; w < words; ++w)
+            if ((species[a * words + w] & ~species[b * words + w]) != 0)
+                return false;
+
+        return true;
+    };
+
+    std::vector<std::vector<size_t>> overlaps(chars.size());
+    std::vector<size_t> seen(chars.size(), chars.size());
+    for (size_t i = 0; i < chars.size(); ++i) {
+        // the characters sharing a species with chars[i], each one once
+        for (RBVertex s : get_adj_vertices(chars[i], g)) {
+            for (size_t j : chars_of[species_bit.at(s)]) {
+                if (j <= i || seen[j] == i)
+                    continue;
+
+                seen[j] = i;
+                if (!included(i, j) && !included(j, i)) {
+                    overlaps[i].push_back(j);
+                    overlaps[j].push_back(i);
+                }
+            }
+        }
+    }
+
+    for (auto &adjacent : overlaps)
+        std::sort(adjacent.begin(), adjacent.end());
+
+    return overlaps;
+}
+
+
 std::list<RBVertex> get_inactive_chars(const RBGraph &g) {
     std::list<RBVertex> list_result;
 
@@ -970,6 +1122,9 @@ std::list<RBVertex> get_inactive_chars(const RBGraph &g) {
 
 
 const std::list<RBVertex> maximal_characters(const RBGraph &g) {
+    if (MaximalCharacterIndex *index = get_maximal_index(g))
+        return index->characters();
+
     std::list<RBVertex> cm;
 
     std::list<RBVertex> inactive_chars = get_inactive_chars(g);
@@ -980,6 +1135,7 @@ const std::list<RBVertex> maximal_characters(const RBGraph &g) {
     // is inserted in cm
     bool is_maximal, v_includes_any_u;
     for (RBVertex v : inactive_chars) {
+        check_deadline("maximal characters");
 
         is_maximal = true;
         v_includes_any_u = false;
@@ -1014,8 +1170,672 @@ const std::list<RBVertex> maximal_characters(const RBGraph &g) {
     return cm;
 }
 
+namespace {
+
+/**
+  Maximal character indices attached to a graph by a MaximalIndexScope
+*/
+thread_local std::vector<std::pair<const RBGraph *, MaximalCharacterIndex *>> maximal_indices;
+
+/**
+  Worklists attached to a graph by a WorklistScope
+*/
+thread_local std::vector<std::pair<const RBGraph *, Worklists *>> worklist_scopes;
+
+}  // namespace
+
+
+MaximalCharacterIndex::MaximalCharacterIndex(const RBGraph &g) : g(g) {
+    build();
+}
+
+
+bool MaximalCharacterIndex::is_maximal(const RBVertex &c) {
+    if (stale)
+        build();
+
+    const auto entry = entries.find(c);
+    return (entry != entries.end() && entry->second.container == nullptr);
+}
+
+
+RBVertex MaximalCharacterIndex::maximal_containing(const RBVertex &c) {
+    if (stale)
+        build();
+
+    const auto entry = entries.find(c);
+    if (entry == entries.end())
+        return nullptr;
+
+    return (entry->second.container == nullptr ? c : entry->second.container);
+}
+
+
+std::list<RBVertex> MaximalCharacterIndex::characters() {
+    if (stale)
+        build();
+
+    std::list<RBVertex> cm;
+    for (RBVertex v : g.m_vertices) {
+        const auto entry = entries.find(v);
+        if (entry != entries.end() && entry->second.container == nullptr)
+            cm.push_back(v);
+    }
+
+    // same order of sort_by_degree: by decreasing size, stable
+    cm.sort([this](const RBVertex &a, const RBVertex &b) {
+        return entries.at(a).size > entries.at(b).size;
+    });
+
+    return cm;
+}
+
+
+void MaximalCharacterIndex::add_edge(const RBVertex &s, const RBVertex &c, const Color color) {
+    // red edges are added to the characters being activated, which are no
+    // longer in the index
+    if (color == Color::black || entries.count(c) > 0)
+        stale = true;
+}
+
+
+void MaximalCharacterIndex::remove_edge(const RBVertex &s, const RBVertex &c) {
+    if (stale)
+        return;
+
+    const auto entry = entries.find(c);
+    const auto bit = species_bit.find(s);
+    if (entry == entries.end() || bit == species_bit.end())
+        return;
+
+    uint64_t &word = entry->second.species[bit->second / 64];
+    const uint64_t mask = uint64_t(1) << (bit->second % 64);
+    if ((word & mask) == 0)
+        return;
+
+    word &= ~mask;
+    if (--entry->second.size == 0)
+        // a character with no edges is not inactive
+        update({}, {c});
+    else
+        update({c}, {});
+}
+
+
+void MaximalCharacterIndex::remove_species(const RBVertex &s) {
+    if (stale)
+        return;
+
+    const auto bit = species_bit.find(s);
+    if (bit == species_bit.end())
+        return;
+
+    const size_t w = bit->second / 64;
+    const uint64_t mask = uint64_t(1) << (bit->second % 64);
+    species_bit.erase(bit);
+
+    std::vector<RBVertex> shrunk, removed;
+    for (auto &entry : entries) {
+        if ((entry.second.species[w] & mask) == 0)
+            continue;
+
+        entry.second.species[w] &= ~mask;
+        if (--entry.second.size == 0)
+            removed.push_back(entry.first);
+        else
+            shrunk.push_back(entry.first);
+    }
+
+    if (!shrunk.empty() || !removed.empty())
+        update(shrunk, removed);
+}
+
+
+void MaximalCharacterIndex::remove_character(const RBVertex &c) {
+    if (stale || entries.count(c) == 0)
+        return;
+
+    update({}, {c});
+}
+
+
+void MaximalCharacterIndex::build() {
+    stale = false;
+    species_bit.clear();
+    entries.clear();
+    maximal.clear();
+
+    for (RBVertex v : g.m_vertices) {
+        if (is_species(v, g)) {
+            const size_t bit = species_bit.size();
+            species_bit[v] = bit;
+        }
+    }
+
+    const size_t words = (species_bit.size() + 63) / 64;
+
+    std::vector<RBVertex> characters;
+    size_t order = 0;
+    for (RBVertex v : g.m_vertices) {
+        ++order;
+        if (!is_character(v, g) || !is_inactive(v, g))
+            continue;
+
+        Entry &entry = entries[v];
+        entry.order = order;
+        entry.species.assign(words, 0);
+        for (RBVertex u : get_adj_vertices(v, g)) {
+            const size_t bit = species_bit.at(u);
+            entry.species[bit / 64] |= uint64_t(1) << (bit % 64);
+            ++entry.size;
+        }
+
+        characters.push_back(v);
+    }
+
+    check(characters);
+}
+
+
+bool MaximalCharacterIndex::precedes(const Entry &a, const Entry &b) const {
+    return (a.size > b.size || (a.size == b.size && a.order < b.order));
+}
+
+
+void MaximalCharacterIndex::update(const std::vector<RBVertex> &shrunk,
+                                   const std::vector<RBVertex> &removed) {
+    // the characters whose container shrunk or is removed are checked again
+    std::set<RBVertex> containers(removed.begin(), removed.end());
+    for (RBVertex c : shrunk)
+        if (entries.at(c).container == nullptr)
+            containers.insert(c);
+
+    for (RBVertex c : removed) {
+        if (entries.at(c).container == nullptr)
+            maximal.erase(std::find(maximal.begin(), maximal.end(), c));
+
+        entries.erase(c);
+    }
+
+    std::vector<RBVertex> changed = shrunk;
+    for (const auto &entry : entries) {
+        if (entry.second.container != nullptr && containers.count(entry.second.container) > 0 &&
+            std::find(shrunk.begin(), shrunk.end(), entry.first) == shrunk.end())
+            changed.push_back(entry.first);
+    }
+
+    check(changed);
+}
+
+
+void MaximalCharacterIndex::check(std::vector<RBVertex> &changed) {
+    for (RBVertex c : changed) {
+        if (entries.at(c).container == nullptr) {
+            const auto it = std::find(maximal.begin(), maximal.end(), c);
+            if (it != maximal.end())
+                maximal.erase(it);
+        }
+    }
+
+    // a character is dominated only by characters coming before it, which
+    // are checked first
+    std::sort(changed.begin(), changed.end(), [this](const RBVertex &a, const RBVertex &b) {
+        return precedes(entries.at(a), entries.at(b));
+    });
+
+    for (RBVertex c : changed) {
+        Entry &entry = entries.at(c);
+        entry.container = nullptr;
+
+        for (RBVertex m : maximal) {
+            const Entry &max_entry = entries.at(m);
+            if (!precedes(max_entry, entry))
+                continue;
+
+            bool included = true;
+            for (size_t w = 0; w < entry.species.size() && included; ++w)
+                included = ((entry.species[w] & ~max_entry.species[w]) == 0);
+
+            if (included) {
+                entry.container = m;
+                break;
+            }
+        }
+
+        if (entry.container == nullptr)
+            maximal.push_back(c);
+    }
+}
+
+
+MaximalIndexScope::MaximalIndexScope(const RBGraph &g) : index_(g) {
+    maximal_indices.emplace_back(&g, &index_);
+}
+
+
+MaximalIndexScope::~MaximalIndexScope() {
+    // scopes owned by other objects may not end in reverse order
+    for (auto it = maximal_indices.rbegin(); it != maximal_indices.rend(); ++it) {
+        if (it->second == &index_) {
+            maximal_indices.erase(std::next(it).base());
+            break;
+        }
+    }
+}
+
+
+MaximalCharacterIndex *get_maximal_index(const RBGraph &g) {
+    for (auto it = maximal_indices.rbegin(); it != maximal_indices.rend(); ++it)
+        if (it->first == &g)
+            return it->second;
+
+    return nullptr;
+}
+
+
+std::list<RBVertex> SpeciesHasse::supersets(const RBVertex &s) {
+    if (stale)
+        build();
+
+    std::list<RBVertex> output;
+
+    const auto entry = node_of.find(s);
+    if (entry == node_of.end() || entry->second == none)
+        return output;
+
+    // nodes above the node of s
+    std::vector<size_t> above, stack = {entry->second};
+    std::unordered_set<size_t> seen = {entry->second};
+    while (!stack.empty()) {
+        const size_t n = stack.back();
+        stack.pop_back();
+
+        for (const size_t u : nodes.at(n).up) {
+            if (seen.insert(u).second) {
+                above.push_back(u);
+                stack.push_back(u);
+            }
+        }
+    }
+
+    std::vector<std::pair<size_t, RBVertex>> species;
+    for (const size_t n : above)
+        for (RBVertex u : nodes.at(n).species)
+            species.emplace_back(nodes.at(n).characters.size(), u);
+
+    std::sort(species.begin(), species.end(),
+              [](const std::pair<size_t, RBVertex> &a, const std::pair<size_t, RBVertex> &b) {
+                  return (a.first != b.first ? a.first < b.first
+                                             : std::less<RBVertex>()(a.second, b.second));
+              });
+
+    for (const auto &u : species)
+        output.push_back(u.second);
+
+    return output;
+}
+
+
+void SpeciesHasse::add_vertex(const RBVertex &v) {
+    if (stale)
+        return;
+
+    if (is_species(v, g))
+        node_of[v] = none;
+    else
+        inactive[v] = is_inactive(v, g);
+}
+
+
+void SpeciesHasse::remove_vertex(const RBVertex &v) {
+    if (stale)
+        return;
+
+    if (is_species(v, g)) {
+        erase(v);
+        node_of.erase(v);
+    } else {
+        // the species of v are updated with the changed vertices
+        inactive.erase(v);
+    }
+}
+
+
+void SpeciesHasse::update(const std::vector<RBVertex> &changed) {
+    if (stale)
+        return;
+
+    // the vertices removed from the graph are no longer in the maps
+    std::vector<RBVertex> species;
+    for (RBVertex v : changed) {
+        const auto c = inactive.find(v);
+        if (c != inactive.end()) {
+            const bool now_inactive = is_inactive(v, g);
+            if (now_inactive != c->second) {
+                // the inactive characters of each species of v changed
+                c->second = now_inactive;
+                for (RBVertex u : get_adj_vertices(v, g))
+                    species.push_back(u);
+            }
+        } else if (node_of.count(v) > 0) {
+            species.push_back(v);
+        }
+    }
+
+    std::sort(species.begin(), species.end());
+    species.erase(std::unique(species.begin(), species.end()), species.end());
+
+    // the species are removed first, so no node is left with old characters
+    std::vector<std::pair<RBVertex, std::vector<RBVertex>>> moved;
+    for (RBVertex s : species) {
+        std::vector<RBVertex> characters = inactive_characters(s);
+        const size_t n = node_of.at(s);
+        if (n == none ? characters.empty() : characters == nodes.at(n).characters)
+            continue;
+
+        erase(s);
+        moved.emplace_back(s, std::move(characters));
+    }
+
+    for (const auto &s : moved)
+        insert(s.first, s.second);
+}
+
+
+void SpeciesHasse::build() {
+    stale = false;
+    next_node = 0;
+    nodes.clear();
+    node_of_set.clear();
+    node_of.clear();
+    inactive.clear();
+
+    for (RBVertex v : g.m_vertices)
+        if (is_character(v, g))
+            inactive[v] = is_inactive(v, g);
+
+    for (RBVertex v : g.m_vertices) {
+        if (is_species(v, g)) {
+            node_of[v] = none;
+            insert(v, inactive_characters(v));
+        }
+    }
+}
+
+
+std::vector<RBVertex> SpeciesHasse::inactive_characters(const RBVertex &s) const {
+    std::vector<RBVertex> characters;
+    for (RBVertex c : get_adj_vertices(s, g))
+        if (is_inactive(c, g))
+            characters.push_back(c);
+
+    std::sort(characters.begin(), characters.end());
+    return characters;
+}
+
+
+void SpeciesHasse::insert(const RBVertex &s, const std::vector<RBVertex> &characters) {
+    if (characters.empty()) {
+        node_of[s] = none;
+        return;
+    }
+
+    const auto found = node_of_set.find(characters);
+    if (found != node_of_set.end()) {
+        nodes.at(found->second).species.insert(s);
+        node_of[s] = found->second;
+        return;
+    }
+
+    // nodes strictly above and below the new node
+    std::unordered_set<size_t> above, below;
+    for (const auto &node : nodes) {
+        const std::vector<RBVertex> &other = node.second.characters;
+        if (other.size() > characters.size() &&
+            std::includes(other.begin(), other.end(), characters.begin(), characters.end()))
+            above.insert(node.first);
+        else if (other.size() < characters.size() &&
+                 std::includes(characters.begin(), characters.end(), other.begin(), other.end()))
+            below.insert(node.first);
+    }
+
+    // the minimal nodes above and the maximal nodes below cover the new node
+    std::vector<size_t> uppers, lowers;
+    for (const size_t u : above) {
+        const std::set<size_t> &down = nodes.at(u).down;
+        if (std::none_of(down.begin(), down.end(), [&above](const size_t d) { return above.count(d) > 0; }))
+            uppers.push_back(u);
+    }
+    for (const size_t d : below) {
+        const std::set<size_t> &up = nodes.at(d).up;
+        if (std::none_of(up.begin(), up.end(), [&below](const size_t u) { return below.count(u) > 0; }))
+            lowers.push_back(d);
+    }
+
+    const size_t id = next_node++;
+    Node &node = nodes[id];
+    node.characters = characters;
+    node.species.insert(s);
+    node_of_set[characters] = id;
+    node_of[s] = id;
+
+    for (const size_t d : lowers) {
+        for (const size_t u : uppers) {
+            // d and u are now linked through the new node
+            nodes.at(d).up.erase(u);
+            nodes.at(u).down.erase(d);
+        }
+    }
+
+    for (const size_t d : lowers)
+        link(d, id);
+    for (const size_t u : uppers)
+        link(id, u);
+}
+
+
+void SpeciesHasse::erase(const RBVertex &s) {
+    const auto entry = node_of.find(s);
+    if (entry == node_of.end() || entry->second == none)
+        return;
+
+    const size_t id = entry->second;
+    entry->second = none;
+
+    Node &node = nodes.at(id);
+    node.species.erase(s);
+    if (!node.species.empty())
+        return;
+
+    const std::vector<size_t> lowers(node.down.begin(), node.down.end());
+    const std::vector<size_t> uppers(node.up.begin(), node.up.end());
+    for (const size_t d : lowers)
+        nodes.at(d).up.erase(id);
+    for (const size_t u : uppers)
+        nodes.at(u).down.erase(id);
+
+    for (const size_t d : lowers) {
+        for (const size_t u : uppers) {
+            // d is covered by u, unless another node covering d is below u
+            const std::vector<RBVertex> &upper = nodes.at(u).characters;
+            const std::set<size_t> &up = nodes.at(d).up;
+            const bool covered = std::any_of(up.begin(), up.end(), [this, &upper](const size_t x) {
+                const std::vector<RBVertex> &other = nodes.at(x).characters;
+                return std::includes(upper.begin(), upper.end(), other.begin(), other.end());
+            });
+
+            if (!covered)
+                link(d, u);
+        }
+    }
+
+    node_of_set.erase(node.characters);
+    nodes.erase(id);
+}
+
+
+void SpeciesHasse::link(const size_t lower, const size_t upper) {
+    nodes.at(lower).up.insert(upper);
+    nodes.at(upper).down.insert(lower);
+}
+
+
+Worklists::Worklists(const RBGraph &g) : g(g), hasse_(g) {
+    build();
+}
+
+
+std::list<RBVertex> Worklists::list(const Worklist list) {
+    flush();
+
+    std::list<RBVertex> output;
+    for (const auto &v : lists[static_cast<size_t>(list)])
+        output.push_back(v.second);
+
+    return output;
+}
+
+
+size_t Worklists::size(const Worklist list) {
+    flush();
+
+    return lists[static_cast<size_t>(list)].size();
+}
+
+
+SpeciesHasse &Worklists::hasse() {
+    flush();
+
+    return hasse_;
+}
+
+
+void Worklists::add_vertex(const RBVertex &v) {
+    // v is added at the end of the vertex list
+    entries[v].order = next_order++;
+    hasse_.add_vertex(v);
+    touch(v);
+}
+
+
+void Worklists::remove_vertex(const RBVertex &v) {
+    hasse_.remove_vertex(v);
+
+    const auto entry = entries.find(v);
+    if (entry == entries.end())
+        return;
+
+    update(v, entry->second, 0);
+    entries.erase(entry);
+}
+
+
+void Worklists::build() {
+    stale = false;
+    hasse_.invalidate();
+    next_order = 0;
+    entries.clear();
+    changed.clear();
+    for (auto &list : lists)
+        list.clear();
+
+    for (RBVertex v : g.m_vertices) {
+        Entry &entry = entries[v];
+        entry.order = next_order++;
+        update(v, entry, classify(v));
+    }
+}
+
+
+void Worklists::flush() {
+    if (stale) {
+        build();
+        return;
+    }
+
+    for (RBVertex v : changed) {
+        const auto entry = entries.find(v);
+        if (entry != entries.end())
+            update(v, entry->second, classify(v));
+    }
+
+    hasse_.update(changed);
+    changed.clear();
+}
+
+
+unsigned Worklists::classify(const RBVertex &v) const {
+    size_t black_edges = 0, red_edges = 0;
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(v, g);
+    for (; e != e_end; ++e) {
+        if (is_black(*e, g))
+            ++black_edges;
+        else
+            ++red_edges;
+    }
+
+    auto bit = [](const Worklist list) {
+        return 1u << static_cast<size_t>(list);
+    };
+
+    unsigned bits = 0;
+    if (is_species(v, g)) {
+        if (black_edges == 1 && red_edges == 0)
+            bits |= bit(Worklist::pending_species);
+        if (red_edges == 0)
+            bits |= bit(Worklist::active_species);
+        if (black_edges > 0 && red_edges > 0)
+            bits |= bit(Worklist::mixed_species);
+    } else if (black_edges == 0) {
+        bits |= bit(Worklist::active_characters);
+    }
+
+    return bits;
+}
+
+
+void Worklists::update(const RBVertex &v, Entry &entry, const unsigned bits) {
+    for (size_t i = 0; i < num_lists; ++i) {
+        const bool was_in = (entry.lists >> i) & 1, is_in = (bits >> i) & 1;
+
+        if (was_in && !is_in)
+            lists[i].erase(entry.order);
+        else if (!was_in && is_in)
+            lists[i].emplace(entry.order, v);
+    }
+
+    entry.lists = bits;
+}
+
+
+WorklistScope::WorklistScope(const RBGraph &g) : worklists_(g) {
+    worklist_scopes.emplace_back(&g, &worklists_);
+}
+
+
+WorklistScope::~WorklistScope() {
+    // scopes owned by other objects may not end in reverse order
+    for (auto it = worklist_scopes.rbegin(); it != worklist_scopes.rend(); ++it) {
+        if (it->second == &worklists_) {
+            worklist_scopes.erase(std::next(it).base());
+            break;
+        }
+    }
+}
+
+
+Worklists *get_worklists(const RBGraph &g) {
+    for (auto it = worklist_scopes.rbegin(); it != worklist_scopes.rend(); ++it)
+        if (it->first == &g)
+            return it->second;
+
+    return nullptr;
+}
+
+
 void g_skeleton(const RBGraph &g, RBGraph &gm) {
-    gm.clear();
+    clear(gm);
     // g_skeleton is coposed by Maximal Inactive Chars && Active Chars
     const auto cm = maximal_characters(g);
     const auto ca = get_active_chars(g);
@@ -1070,9 +1890,11 @@ void maximal_reducible_graph(const RBGraph &g, RBGraph &gm, const bool active) {
         //std::cout << "} - Count: " << cm.size() << std::endl;
     }
 
-    gm.clear();
+    clear(gm);
 
     for (RBVertex v : cm) {
+        check_deadline("maximal reducible graph");
+
         add_character(g[v].name, gm);
 
         RBOutEdgeIter e, e_end;
@@ -1187,6 +2009,13 @@ bool has_red_sigmapath(const RBVertex c0, const RBVertex c1, const RBGraph &g) {
 
 
 void change_char_type(const RBVertex &v, RBGraph &g) {
+    if (MaximalCharacterIndex *index = get_maximal_index(g)) {
+        if (is_inactive(v, g))
+            index->remove_character(v);
+        else
+            index->invalidate();
+    }
+
     // get the black edges in v
     RBOutEdgeIter e, e_end;
     std::tie(e, e_end) = out_edges(v, g);
@@ -1204,7 +2033,7 @@ void change_char_type(const RBVertex &v, RBGraph &g) {
         ++u;
     }
 
-    boost::clear_vertex(v, g);
+    clear_vertex(v, g);
 
     u = species_red_edges.begin();
     u_end = species_red_edges.end();
@@ -1216,6 +2045,9 @@ void change_char_type(const RBVertex &v, RBGraph &g) {
 
 
 std::list<RBVertex> get_active_chars(const RBGraph &g) {
+    if (Worklists *worklists = get_worklists(g))
+        return worklists->list(Worklist::active_characters);
+
     std::list<RBVertex> ac;
     RBVertexIter v, v_end;
 
@@ -1230,6 +2062,9 @@ std::list<RBVertex> get_active_chars(const RBGraph &g) {
 
 
 std::list<RBVertex> get_active_species(const RBGraph &g) {
+    if (Worklists *worklists = get_worklists(g))
+        return worklists->list(Worklist::active_species);
+
     std::list<RBVertex> active_species;
     for (RBVertex v : g.m_vertices)
         if (is_species(v, g) && is_active(v, g))
@@ -1239,38 +2074,29 @@ std::list<RBVertex> get_active_species(const RBGraph &g) {
 
 
 std::list<RBVertex> get_comp_vertex(const RBVertex &u, const RBGraph &g) {
+    const ComponentIndex &index = component_index(g);
 
+    // the vertices of the other type in the component of u
     std::list<RBVertex> result;
-    RBGraphVector connected_comp_vec = connected_components(g);
+    ComponentIndex::VertexIter v, v_end;
+    std::tie(v, v_end) = index.component(index.component_id(u));
+    for (; v != v_end; ++v)
+        if (g[u].type != g[*v].type)
+            result.push_back(*v);
 
-    if (connected_comp_vec.size() == 1) {
-        // only a connected component, then return all the species of g
-        for (RBVertex v : g.m_vertices)
-            if (g[u].type != g[v].type)
-                result.push_back(v);
-    } else {
-        // more than a component => then find the component in which c is located and return the species included in such component
-        auto comp = connected_comp_vec.begin();
-        auto comp_end = connected_comp_vec.end();
-        for (; comp != comp_end; ++comp)
-            if (exists(g[u].name, *comp->get())) {
-                for (RBVertex v : comp->get()->m_vertices)
-                    if (g[u].type != (*comp->get())[v].type)
-                        result.push_back(get_vertex((*comp->get())[v].name, g));
-                break;
-            }
-    }
     return result;
 }
 
 
 std::list<RBVertex> get_comp_active_characters(const RBVertex s, const RBGraph &g) {
-    std::list<RBVertex> result;
-    std::list<RBVertex> char_list = get_comp_vertex(s, g);
+    const ComponentIndex &index = component_index(g);
 
-    for (RBVertex c : char_list)
-        if (is_active(c, g))
-            result.push_back(c);
+    std::list<RBVertex> result;
+    ComponentIndex::VertexIter v, v_end;
+    std::tie(v, v_end) = index.component(index.component_id(s));
+    for (; v != v_end; ++v)
+        if (g[s].type != g[*v].type && is_active(*v, g))
+            result.push_back(*v);
 
     return result;
 }
@@ -1303,57 +2129,47 @@ void minimal_form_graph(const RBGraph &g, RBGraph &gmf) {
 
 
     std::list<RBVertex> cmax = maximal_characters(g);
+    const std::set<RBVertex> cmax_set(cmax.begin(), cmax.end());
 
     // get the minimal characters as follow:
     // cmin = char_vertex(g) - cmax(g) - species_vertex(g)
-    std::list<RBVertex> cmin(g.m_vertices.begin(), g.m_vertices.end());
-    RBVertexIter b = cmin.begin(), e = cmin.end(), next;
-    for (next = b; b != e; b = next) {
-        ++next;
-        if (is_species(*b, g))
-            cmin.remove(*b);
-        for (RBVertex v : cmax)
-            if (g[*b].name == g[v].name) {
-                cmin.remove(*b);
-                break;
-            }
-    }
+    // chars holds cmin, then cmax
+    std::vector<RBVertex> chars;
+    for (RBVertex v : g.m_vertices)
+        if (!is_species(v, g) && cmax_set.count(v) == 0)
+            chars.push_back(v);
 
-    // let v be a minimal character, then:
-    // overlap_map[v] = set of minimal characters that overlap with v
-    // TODO if the matrix is big, overlaps_character is slow
-    std::map<RBVertex, std::set<RBVertex>> overlap_map;
-    RBVertexIter v = cmin.begin(), end = cmin.end(), u;
-    for (; v != end; ++v) {
-        //for all minimal characters from 1 to N
-        for (u = v; u != end; ++u) {
-            // for all minimal characters from v to N
-            if (u != v && overlaps_character(*v, *u, g)) {
-                overlap_map[*v].insert(*u);
-                overlap_map[*u].insert(*v);
-            }
-        }
-    }
+    const size_t num_cmin = chars.size();
+    chars.insert(chars.end(), cmax.begin(), cmax.end());
 
-    // min_max_overlap will contain all the minimal characters that overlap with at least a maximal character
-    std::set<RBVertex> min_max_overlap;
-    for (RBVertex v : cmin)
-        for (RBVertex u : cmax)
-            if (overlaps_character(v, u, g))
-                min_max_overlap.insert(v);
+    const std::vector<std::vector<size_t>> overlaps = overlap_graph(chars, g);
 
-    // make the union between the sets of overlapping minimal characters that also overlap with at least a maximal character
+    // for each minimal character that overlaps with at least a maximal
+    // character, add the minimal characters overlapping with it
     std::set<RBVertex> minimal_form_characters;
-    for (RBVertex v : min_max_overlap)
-        minimal_form_characters.insert(overlap_map[v].begin(), overlap_map[v].end());
+    for (size_t i = 0; i < num_cmin; ++i) {
+        if (overlaps[i].empty() || overlaps[i].back() < num_cmin)
+            continue;
+
+        for (size_t j : overlaps[i]) {
+            if (j >= num_cmin)
+                break;
+
+            minimal_form_characters.insert(chars[j]);
+        }
+    }
 
     // add also the maximal characters
     for (RBVertex v : cmax)
         minimal_form_characters.insert(v);
 
-    // build the minimal form graph
-    gmf.clear();
-    for (RBVertex v : minimal_form_characters) {
+    // build the minimal form graph, adding the characters in the order of g
+    // rather than in the order of their addresses
+    clear(gmf);
+    for (RBVertex v : g.m_vertices) {
+        if (minimal_form_characters.count(v) == 0)
+            continue;
+
         add_character(g[v].name, gmf);
         RBOutEdgeIter edge, edge_end;
         std::tie(edge, edge_end) = out_edges(v, g);
@@ -10,7 +10,10 @@
 #define RBGRAPH_HPP
 
 #include <boost/graph/adjacency_list.hpp>
+#include <cstdint>
 #include <iostream>
+#include <set>
+#include <unordered_map>
 #include "globals.hpp"
 
 //=============================================================================
@@ -57,6 +60,18 @@ enum class Type : bool {
     character  ///< The labeled vertex is a character
 };
 
+
+/**
+  Scoped enumeration type whose underlying size is 1 byte, used for the engine
+  of the consecutive ones test.
+
+  C1PEngine is used to select the algorithm in has_consecutive_ones_property.
+*/
+enum class C1PEngine : bool {
+    lexbfs,  ///< LexBFS-based test by Hackob (src/LexBFS-master)
+    pqtree   ///< Booth-Lueker PQ-tree, O(rows + cols + ones)
+};
+
 //=============================================================================
 // Bundled properties
 
@@ -84,6 +99,12 @@ struct RBVertexProperties {
 };
 
 
+/**
+  @brief Return a new graph version, never returned before in the process.
+*/
+size_t new_version();
+
+
 /**
   @brief Struct used to represent the properties of a red-black graph
 */
@@ -93,6 +114,8 @@ struct RBGraphProperties {
 
     RBVertexNameMap vertex_map{};  ///< Map for vertex names and vertices in the
     ///< graph
+
+    size_t version = new_version();  ///< Version, changed by each change of the graph
 };
 
 //=============================================================================
@@ -282,6 +305,17 @@ inline void remove_edge(const RBEdge &e, RBGraph &g) {
 }
 
 
+/**
+  @brief Remove all the edges of \e v from \e g .
+
+  The maximal character index attached to \e g, if any, is not updated.
+
+  @param[in]     v Vertex
+  @param[in,out] g Red-black graph
+*/
+void clear_vertex(const RBVertex &v, RBGraph &g);
+
+
 /**
   @brief Remove \e v from \e g .
 
@@ -472,6 +506,32 @@ inline const RBVertexNameMap &vertex_map(const RBGraph &g) {
 }
 
 
+/**
+  @brief Return the version of \e g .
+
+  The version changes with each function changing the vertices or the edges
+  of \e g, and it is unique among the graphs of the process, so data derived
+  from \e g can be reused while the version does not change.
+
+  @param[in] g Red-black graph
+
+  @return Version of \e g
+*/
+inline size_t version(const RBGraph &g) {
+    return g[boost::graph_bundle].version;
+}
+
+
+/**
+  @brief Give a new version to \e g, after a change of \e g .
+
+  @param[in,out] g Red-black graph
+*/
+inline void bump_version(RBGraph &g) {
+    g[boost::graph_bundle].version = new_version();
+}
+
+
 /**
   @brief Remove \e v from \e g if it satisfies \e predicate .
 
@@ -483,6 +543,7 @@ template<typename Predicate>
 void remove_vertex_if(const RBVertex &v, Predicate predicate, RBGraph &g) {
     if (predicate(v, g)) {
         // vertex satisfies the predicate
+        bump_version(g);
         clear_vertex(v, g);
         remove_vertex(v, g);
     }
@@ -679,6 +740,21 @@ std::ostream &operator<<(std::ostream &os, const RBGraph &g);
 void get_matrix_representation(const RBGraph &g, bool **m, size_t rows, size_t cols);
 
 
+/**
+  @brief Get the sparse matrix representation of \e g in O(|V| + |E|).
+
+  Column i of the matrix is the character \e characters[i], while row i is the
+  i-th species of \e g and lists the columns of its inactive characters, in
+  the same order used by get_matrix_representation.
+
+  @param[in]  g          Red-black graph
+  @param[out] characters Character of each column
+  @param[out] rows       Rows of the matrix, as lists of column indices
+*/
+void get_sparse_representation(const RBGraph &g, std::vector<RBVertex> &characters,
+                               std::vector<std::vector<size_t>> &rows);
+
+
 // File I/O
 
 /**
@@ -690,6 +766,15 @@ void get_matrix_representation(const RBGraph &g, bool **m, size_t rows, size_t c
 void read_graph(const std::string &filename, RBGraph &g);
 
 
+/**
+  @brief Read from the stream \e is into \e g .
+
+  @param[in]  is Input stream
+  @param[out] g  Red-black graph
+*/
+void read_graph(std::istream &is, RBGraph &g);
+
+
 //=============================================================================
 // Algorithm functions
 
@@ -823,6 +908,62 @@ RBGraphVector connected_components(const RBGraph &g, const RBVertexIMap &c_map,
                                    const size_t c_count);
 
 
+/**
+  @brief Class used to label the connected components of a graph
+
+  The components are numbered in the order of their first vertex in the
+  vertex list of the graph, and the vertices of each component are kept
+  contiguous, in the order of the vertex list, so a component is a range of
+  vertices and the component of a vertex is a lookup. Unlike
+  connected_components, no subgraph is built.
+*/
+class ComponentIndex {
+public:
+    typedef std::vector<RBVertex>::const_iterator VertexIter;  ///< Iterator of a component
+
+    /**
+      @brief Label the connected components of \e g .
+    */
+    explicit ComponentIndex(const RBGraph &g);
+
+    /**
+      @brief Return the number of connected components.
+    */
+    size_t num_components() const { return start.size() - 1; }
+
+    /**
+      @brief Return the connected component of the vertex \e v .
+    */
+    size_t component_id(const RBVertex &v) const { return id.at(v); }
+
+    /**
+      @brief Return the range of vertices of the connected component \e c .
+    */
+    std::pair<VertexIter, VertexIter> component(const size_t c) const {
+        return {order.begin() + start[c], order.begin() + start[c + 1]};
+    }
+
+private:
+    std::unordered_map<RBVertex, size_t> id{};  ///< Component of each vertex
+    std::vector<RBVertex> order{};              ///< Vertices, grouped by component
+    std::vector<size_t> start{0};               ///< Start of each component in order
+};
+
+
+/**
+  @brief Return the component index of \e g .
+
+  The index of the last graph and version asked by the current thread is
+  kept, so it is computed once per version of \e g ; the reference is valid
+  until the index of another graph or version is asked.
+
+  @param[in] g Red-black graph
+
+  @return Component index of g
+*/
+const ComponentIndex &component_index(const RBGraph &g);
+
+
 /**
   @brief Return the list of neighbors of species v.
 
@@ -941,6 +1082,26 @@ bool overlaps_species(const RBVertex &s1, const RBVertex &s2, const RBGraph &g);
 bool overlaps_character(const RBVertex &c1, const RBVertex &c2, const RBGraph &g);
 
 
+/**
+  @brief Build the overlap graph of the characters \e chars in \e g : c1 and
+  c2 are adjacent if overlaps_character(c1, c2, g).
+
+  The species are swept instead of the pairs of characters, since only the
+  characters sharing a species can overlap; the candidate pairs are then
+  tested on the bitsets of their species. This takes
+  O(sum over s of |C(s)|^2 * n / 64) time instead of O(m^2 d^2), where C(s)
+  are the characters of \e chars adjacent to the species s.
+
+  @param[in] chars Characters
+  @param[in] g     Red black graph
+
+  @return For each character chars[i], the indices in \e chars of the
+          characters overlapping it, in increasing order
+*/
+std::vector<std::vector<size_t>> overlap_graph(const std::vector<RBVertex> &chars,
+                                               const RBGraph &g);
+
+
 /**
   @brief Return the list of inactive characters in \e g .
 
@@ -966,6 +1127,393 @@ std::list<RBVertex> get_inactive_chars(const RBGraph &g);
 const std::list<RBVertex> maximal_characters(const RBGraph &g);
 
 
+/**
+  @brief Class used to maintain the maximal inactive characters of a graph
+  while the graph is reduced
+
+  For each inactive character c the index keeps S(c) as a bitset of species,
+  and a maximal character containing it. A character c is dominated by c' if
+  S(c) ⊆ S(c') and c' comes first in the order of maximal_characters (larger
+  S(c'), or equal S(c') and c' first in the vertex list); the maximal
+  characters are the ones not dominated by any other one.
+
+  The index is updated on the removal of an edge, a species or a character and
+  on the activation of a character, by checking again only the characters
+  whose species or container changed. Any other change of the graph (new black
+  edges, a character made inactive) marks the index as stale, and it is built
+  again at the next query.
+*/
+class MaximalCharacterIndex {
+public:
+    /**
+      @brief Build the index of the inactive characters of \e g .
+    */
+    explicit MaximalCharacterIndex(const RBGraph &g);
+
+    /**
+      @brief Return true if \e c is a maximal inactive character.
+    */
+    bool is_maximal(const RBVertex &c);
+
+    /**
+      @brief Return a maximal character including S(\e c): \e c itself if it
+      is maximal, or nullptr if \e c is not an inactive character.
+    */
+    RBVertex maximal_containing(const RBVertex &c);
+
+    /**
+      @brief Return the maximal characters, in the order of maximal_characters.
+    */
+    std::list<RBVertex> characters();
+
+    /**
+      @brief Update the index after the edge (\e s, \e c) of color \e color
+      is added.
+    */
+    void add_edge(const RBVertex &s, const RBVertex &c, Color color);
+
+    /**
+      @brief Update the index before the edge (\e s, \e c) is removed.
+    */
+    void remove_edge(const RBVertex &s, const RBVertex &c);
+
+    /**
+      @brief Update the index before the species \e s is removed.
+    */
+    void remove_species(const RBVertex &s);
+
+    /**
+      @brief Update the index before the character \e c is removed or
+      activated.
+    */
+    void remove_character(const RBVertex &c);
+
+    /**
+      @brief Mark the index as stale, so that it is built again at the next
+      query.
+    */
+    void invalidate() { stale = true; }
+
+private:
+    /**
+      @brief Struct used to represent an inactive character in the index
+    */
+    struct Entry {
+        size_t order{};                  ///< Position in the vertex list of the graph
+        size_t size{};                   ///< Number of species in S(c)
+        std::vector<uint64_t> species{}; ///< Bitset of S(c)
+        RBVertex container = nullptr;    ///< Maximal character dominating c (nullptr if maximal)
+    };
+
+    const RBGraph &g;                            ///< Indexed graph
+    bool stale = false;                          ///< True if the index must be built again
+    std::map<RBVertex, size_t> species_bit{};    ///< Bit of each species in the bitsets
+    std::map<RBVertex, Entry> entries{};         ///< Inactive characters
+    std::vector<RBVertex> maximal{};             ///< Maximal characters, in no order
+
+    /**
+      @brief Build the index from scratch.
+    */
+    void build();
+
+    /**
+      @brief Return true if \e a comes before \e b in the order of
+      maximal_characters.
+    */
+    bool precedes(const Entry &a, const Entry &b) const;
+
+    /**
+      @brief Update the index after the species of the characters \e shrunk
+      decreased, before the characters \e removed are removed.
+    */
+    void update(const std::vector<RBVertex> &shrunk, const std::vector<RBVertex> &removed);
+
+    /**
+      @brief Find again a container of each character of \e changed, all the
+      other characters being up to date.
+    */
+    void check(std::vector<RBVertex> &changed);
+};
+
+
+/**
+  @brief Scope of a maximal character index of the graph \e g .
+
+  While the scope exists, maximal_characters(g) is answered by the index, and
+  the functions changing \e g in this file and in functions.cpp keep the
+  index up to date. The scopes are local to the thread.
+*/
+class MaximalIndexScope {
+public:
+    /**
+      @brief Build the index of \e g and attach it to \e g .
+    */
+    explicit MaximalIndexScope(const RBGraph &g);
+
+    ~MaximalIndexScope();
+
+    MaximalIndexScope(const MaximalIndexScope &) = delete;
+
+    MaximalIndexScope &operator=(const MaximalIndexScope &) = delete;
+
+    /**
+      @brief Return the index of the scope.
+    */
+    MaximalCharacterIndex &index() { return index_; }
+
+private:
+    MaximalCharacterIndex index_;  ///< Index of the graph
+};
+
+
+/**
+  @brief Return the maximal character index attached to \e g by the innermost
+  MaximalIndexScope, or nullptr if there is none.
+*/
+MaximalCharacterIndex *get_maximal_index(const RBGraph &g);
+
+
+/**
+  @brief Class used to maintain the Hasse diagram of the species of a graph,
+  ordered by inclusion of their inactive characters
+
+  Each node of the diagram is the set of species with the same inactive
+  characters, and is linked to the nodes that cover it and to the nodes it
+  covers; the species with no inactive characters are left out. The diagram
+  is built at the first query, then each change of the graph reported by
+  add_vertex, remove_vertex and update moves only the species whose inactive
+  characters changed, relinking their old and new nodes.
+*/
+class SpeciesHasse {
+public:
+    /**
+      @brief Attach the diagram to \e g; it is built at the first query.
+    */
+    explicit SpeciesHasse(const RBGraph &g) : g(g) {}
+
+    /**
+      @brief Return the species whose inactive characters strictly include the
+      inactive characters of \e s, by increasing number of inactive characters
+      and then in the order of get_neighbors.
+    */
+    std::list<RBVertex> supersets(const RBVertex &s);
+
+    /**
+      @brief Record that \e v has been added to the graph.
+    */
+    void add_vertex(const RBVertex &v);
+
+    /**
+      @brief Update the diagram before \e v is removed from the graph.
+    */
+    void remove_vertex(const RBVertex &v);
+
+    /**
+      @brief Update the diagram after the edges of the vertices \e changed
+      changed.
+    */
+    void update(const std::vector<RBVertex> &changed);
+
+    /**
+      @brief Mark the diagram as stale, so that it is built again at the next
+      query.
+    */
+    void invalidate() { stale = true; }
+
+private:
+    /**
+      @brief Struct used to represent a node of the diagram
+    */
+    struct Node {
+        std::vector<RBVertex> characters{};  ///< Inactive characters, sorted
+        std::set<RBVertex> species{};        ///< Species with these characters
+        std::set<size_t> up{};               ///< Nodes covering this node
+        std::set<size_t> down{};             ///< Nodes covered by this node
+    };
+
+    static const size_t none = SIZE_MAX;
+
+    const RBGraph &g;                                         ///< Graph of the diagram
+    bool stale = true;                                        ///< True if the diagram must be built again
+    size_t next_node = 0;                                     ///< Identifier of the next node
+    std::unordered_map<size_t, Node> nodes{};                 ///< Nodes, by identifier
+    std::map<std::vector<RBVertex>, size_t> node_of_set{};    ///< Node of each set of characters
+    std::unordered_map<RBVertex, size_t> node_of{};           ///< Node of each species (none if left out)
+    std::unordered_map<RBVertex, bool> inactive{};            ///< Inactivity of each character
+
+    /**
+      @brief Build the diagram from scratch.
+    */
+    void build();
+
+    /**
+      @brief Return the inactive characters of the species \e s, sorted.
+    */
+    std::vector<RBVertex> inactive_characters(const RBVertex &s) const;
+
+    /**
+      @brief Add the species \e s to the node of \e characters, its inactive
+      characters.
+    */
+    void insert(const RBVertex &s, const std::vector<RBVertex> &characters);
+
+    /**
+      @brief Link the node \e lower to the node \e upper covering it.
+    */
+    void link(size_t lower, size_t upper);
+
+    /**
+      @brief Remove the species \e s from its node.
+    */
+    void erase(const RBVertex &s);
+};
+
+
+/**
+  @brief Lists of vertices of a graph
+*/
+enum class Worklist {
+    pending_species,    ///< Species with just a black edge
+    active_species,     ///< Species with no red edges
+    active_characters,  ///< Characters with no black edges
+    mixed_species       ///< Species with black and red edges
+};
+
+
+/**
+  @brief Class used to maintain lists of vertices of a graph that depend only
+  on the edges of each vertex
+
+  The functions changing the graph record in a journal the vertices whose
+  edges changed; at the next query the index classifies again only these
+  vertices. The lists are in the order of the vertices of the graph. The
+  journal also keeps the Hasse diagram of the species up to date.
+*/
+class Worklists {
+public:
+    /**
+      @brief Build the lists of \e g .
+    */
+    explicit Worklists(const RBGraph &g);
+
+    /**
+      @brief Return the vertices in \e list .
+    */
+    std::list<RBVertex> list(Worklist list);
+
+    /**
+      @brief Return the number of vertices in \e list .
+    */
+    size_t size(Worklist list);
+
+    /**
+      @brief Record that \e v has been added to the graph.
+    */
+    void add_vertex(const RBVertex &v);
+
+    /**
+      @brief Update the lists before \e v is removed from the graph.
+    */
+    void remove_vertex(const RBVertex &v);
+
+    /**
+      @brief Record that the edges of \e v changed.
+    */
+    void touch(const RBVertex &v) { changed.push_back(v); }
+
+    /**
+      @brief Mark the lists as stale, so that they are built again at the next
+      query.
+    */
+    void invalidate() {
+        stale = true;
+        hasse_.invalidate();
+    }
+
+    /**
+      @brief Return the Hasse diagram of the species of the graph.
+    */
+    SpeciesHasse &hasse();
+
+private:
+    static const size_t num_lists = 4;
+
+    /**
+      @brief Struct used to represent a vertex in the lists
+    */
+    struct Entry {
+        size_t order{};     ///< Position in the vertex list of the graph
+        unsigned lists{};   ///< Bit i is set if the vertex is in the list i
+    };
+
+    const RBGraph &g;                                   ///< Graph of the lists
+    bool stale = false;                                 ///< True if the lists must be built again
+    size_t next_order = 0;                              ///< Position of the next vertex added
+    std::unordered_map<RBVertex, Entry> entries{};      ///< Vertices of the graph
+    std::vector<RBVertex> changed{};                    ///< Vertices whose edges changed
+    std::map<size_t, RBVertex> lists[num_lists]{};      ///< Vertices of each list, by position
+    SpeciesHasse hasse_;                                ///< Hasse diagram of the species
+
+    /**
+      @brief Build the lists from scratch.
+    */
+    void build();
+
+    /**
+      @brief Classify again the vertices whose edges changed.
+    */
+    void flush();
+
+    /**
+      @brief Return the lists of \e v, as bits.
+    */
+    unsigned classify(const RBVertex &v) const;
+
+    /**
+      @brief Move \e v from the lists of \e entry to the lists \e bits .
+    */
+    void update(const RBVertex &v, Entry &entry, unsigned bits);
+};
+
+
+/**
+  @brief Scope of the worklists of the graph \e g .
+
+  While the scope exists, get_pending_species, get_active_species,
+  get_active_chars and all_species_with_red_edges are answered by the
+  worklists, and the functions changing \e g keep them up to date. The scopes
+  are local to the thread.
+*/
+class WorklistScope {
+public:
+    /**
+      @brief Build the worklists of \e g and attach them to \e g .
+    */
+    explicit WorklistScope(const RBGraph &g);
+
+    ~WorklistScope();
+
+    WorklistScope(const WorklistScope &) = delete;
+
+    WorklistScope &operator=(const WorklistScope &) = delete;
+
+    /**
+      @brief Return the worklists of the scope.
+    */
+    Worklists &worklists() { return worklists_; }
+
+private:
+    Worklists worklists_;  ///< Worklists of the graph
+};
+
+
+/**
+  @brief Return the worklists attached to \e g by the innermost
+  WorklistScope, or nullptr if there are none.
+*/
+Worklists *get_worklists(const RBGraph &g);
+
+
 /**
  * @brief Build the g-skelton \e gm of \e g
  *
@@ -988,6 +1536,8 @@ void g_skeleton(const RBGraph &g, RBGraph &gm);
                     False: ignore all active characters from \e g (GRB|CM).
 
   @return Maximal reducible graph
+
+  @throws TimeoutError if the deadline of the current thread passes
 */
 void maximal_reducible_graph(const RBGraph &g, RBGraph &gm, const bool active = false);
 
@@ -1100,11 +1650,31 @@ void minimal_form_graph(const RBGraph &g, RBGraph &gmf);
 /**
   @brief It returns true if the matrix associated with \e g has the 01 property
 
-  @param[in] g Red-black graph
+  Only black edges are considered: the rows of the matrix are the species and
+  the columns are the inactive characters.
+
+  @param[in] g      Red-black graph
+  @param[in] engine Algorithm used for the test
+
+  @return bool
+**/
+bool has_consecutive_ones_property(RBGraph &g, C1PEngine engine = C1PEngine::pqtree);
+
+
+/**
+  @brief It returns true if the matrix associated with \e g has the 01 property
+
+  If the property holds, \e order is filled with the characters of \e g in an
+  order such that the characters of every species are consecutive.
+
+  @param[in]  g      Red-black graph
+  @param[out] order  Ordering of the characters of \e g
+  @param[in]  engine Algorithm used for the test
 
   @return bool
 **/
-bool has_consecutive_ones_property(RBGraph &g);
+bool has_consecutive_ones_property(RBGraph &g, std::list<RBVertex> &order,
+                                   C1PEngine engine = C1PEngine::pqtree);
 
 
 
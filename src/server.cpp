@@ -0,0 +1,262 @@
+/**
+ *
+ * @file server.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "server.hpp"
+#include "solve.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t max_request_size = 64 << 20;  ///< Largest request accepted, in bytes
+const int receive_timeout_s = 10;          ///< Time a client has to send its request
+
+
+/**
+  @brief Bounded queue of the accepted connections
+*/
+class ConnectionQueue {
+public:
+    explicit ConnectionQueue(const size_t capacity) : capacity(capacity) {}
+
+    /**
+      @brief Add the connection \e fd, waiting while the queue is full.
+    */
+    void push(const int fd) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return connections.size() < capacity; });
+        connections.push_back(fd);
+        not_empty.notify_one();
+    }
+
+    /**
+      @brief Remove the first connection, waiting while the queue is empty.
+    */
+    int pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return !connections.empty(); });
+        const int fd = connections.front();
+        connections.pop_front();
+        not_full.notify_one();
+
+        return fd;
+    }
+
+private:
+    const size_t capacity;               ///< Largest number of queued connections
+    std::deque<int> connections{};       ///< Queued connections
+    std::mutex mutex{};                  ///< Lock of connections
+    std::condition_variable not_full{};  ///< Signaled when a connection is removed
+    std::condition_variable not_empty{}; ///< Signaled when a connection is added
+};
+
+
+/**
+  @brief Read the request of the connection \e fd, until the client shuts
+  down its side of the connection.
+
+  @return False if the request can not be read or is too large
+*/
+bool read_request(const int fd, std::string &request) {
+    char buffer[65536];
+
+    while (true) {
+        const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n == 0)
+            return true;
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        if (request.size() + n > max_request_size)
+            return false;
+
+        request.append(buffer, n);
+    }
+}
+
+
+/**
+  @brief Write \e data to the connection \e fd, ignoring a closed connection.
+*/
+void write_response(const int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+
+        sent += n;
+    }
+}
+
+
+/**
+  @brief Return the response to \e request, solved with the buffers of
+  \e context .
+*/
+std::string answer(const std::string &request, SolverContext &context) {
+    const SolveResult *solved;
+
+    try {
+        std::istringstream is(request);
+        if (request.compare(0, 4, "PPPB") == 0)
+            read_binary_matrix(is, context.matrix);
+        else
+            read_matrix(is, context.matrix);
+
+        solved = &solve_matrix(context);
+    } catch (const std::exception &e) {
+        return std::string("ERROR ") + e.what() + "\n\n";
+    }
+
+    const SolveResult &result = *solved;
+
+    std::ostringstream response;
+    switch (result.outcome) {
+        case Outcome::reduced:
+            response << "OK\n";
+            break;
+
+        case Outcome::not_reduced:
+            response << "FAIL\n";
+            break;
+
+        case Outcome::timeout:
+            response << "TIMEOUT " << result.phase << "\n";
+            break;
+    }
+
+    for (auto sc = result.realized.cbegin(); sc != result.realized.cend(); ++sc)
+        response << (sc == result.realized.cbegin() ? "" : " ") << *sc;
+    response << "\n";
+
+    return response.str();
+}
+
+
+/**
+  @brief Answer the connections of \e queue with \e options, forever.
+*/
+void worker(ConnectionQueue &queue, const GlobalOptions options) {
+    OptionsScope options_scope(options);
+    SolverContext context;
+
+    while (true) {
+        const int fd = queue.pop();
+
+        std::string request;
+        if (read_request(fd, request))
+            write_response(fd, answer(request, context));
+        else
+            write_response(fd, "ERROR [ERROR] Failed to read the request\n\n");
+
+        close(fd);
+    }
+}
+
+
+/**
+  @brief Remove the socket at \e path, if any.
+
+  @return False if \e path exists and is not a socket, which is left as it is
+*/
+bool remove_socket(const std::string &path) {
+    struct stat status{};
+    if (lstat(path.c_str(), &status) != 0)
+        // nothing to remove; any other error is reported by bind()
+        return true;
+
+    if (!S_ISSOCK(status.st_mode))
+        return false;
+
+    unlink(path.c_str());
+    return true;
+}
+
+}  // namespace
+
+
+int serve(const std::string &path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "[ERROR] Socket path too long: " << path << std::endl;
+        return 1;
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    // a socket left by a previous server would make bind() fail, but any
+    // other file is not ours to delete
+    if (!remove_socket(path)) {
+        std::cerr << "[ERROR] Not a socket, refusing to replace it: " << path << std::endl;
+        return 1;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "[ERROR] Failed to create the socket: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "[ERROR] Failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    size_t num_workers = server::workers;
+    if (num_workers == 0)
+        num_workers = std::max(1u, std::thread::hardware_concurrency());
+
+    // connections beyond the queue wait in the listen backlog
+    static ConnectionQueue queue(num_workers);
+    for (size_t i = 0; i < num_workers; ++i)
+        std::thread(worker, std::ref(queue), get_options()).detach();
+
+    std::cout << "[INFO] Serving on " << path << " with " << num_workers << " workers" << std::endl;
+
+    while (true) {
+        const int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+
+            std::cerr << "[ERROR] Failed to accept a connection: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        // a client that never finishes its request must not hold a worker forever
+        timeval timeout{};
+        timeout.tv_sec = receive_timeout_s;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        queue.push(client);
+    }
+
+    close(fd);
+    remove_socket(path);
+
+    return 1;
+}
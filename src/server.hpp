@@ -0,0 +1,41 @@
+/**
+ *
+ * @file server.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Answer the requests of the clients of the Unix domain socket \e path .
+
+  Each connection carries one request: the client sends a matrix, in the
+  format read by read_graph or in the binary format read by
+  read_binary_matrix, and then shuts down its side of the connection. The
+  server answers with two lines: the outcome ("OK", "FAIL", "TIMEOUT <phase>"
+  or "ERROR <message>") and the realized characters, separated by spaces.
+
+  The connections are handled by a pool of server::workers threads, and the
+  accepted connections waiting for a thread are bounded by the size of the
+  pool. The algorithm is selected by the global options, as for the files
+  given on the command line.
+
+  A socket already at \e path is replaced, while any other file at \e path
+  makes the server fail.
+
+  @param[in] path Path of the socket
+
+  @return Exit status, if the socket can not be opened or accepting fails
+*/
+int serve(const std::string &path);
+
+#endif  // SERVER_HPP
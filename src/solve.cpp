@@ -0,0 +1,334 @@
+/**
+ *
+ * @file solve.cpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#include "solve.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+
+namespace {
+
+/**
+  @brief Empty the vector \e v, releasing its memory if its capacity exceeds
+  \e high_water elements.
+*/
+template <typename T>
+void reset_buffer(std::vector<T> &v, const size_t high_water) {
+    v.clear();
+    if (v.capacity() > high_water)
+        std::vector<T>().swap(v);
+}
+
+
+/**
+  @brief Empty the matrix \e m as reset_buffer does for each of its buffers.
+*/
+void reset_matrix(BinaryMatrix &m, const size_t high_water) {
+    m.clear();
+    reset_buffer(m.rows, high_water);
+    reset_buffer(m.cols, high_water);
+    reset_buffer(m.active, high_water);
+    reset_buffer(m.row_ids, high_water);
+    reset_buffer(m.col_ids, high_water);
+}
+
+
+/**
+  @brief Run the PPP algorithm on the submatrix of \e m made of \e columns and
+  of the rows with a one in them.
+
+  @param[in] m       Binary matrix
+  @param[in] columns Columns of a conflict component of m
+
+  @return Realized characters
+*/
+std::list<SignedCharacter> solve_island(const BinaryMatrix &m, std::vector<size_t> columns) {
+    // the graph is built in the order of the columns of m, as the graph of m
+    std::sort(columns.begin(), columns.end());
+
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < m.num_rows; ++i)
+        if (std::any_of(columns.cbegin(), columns.cend(), [&m, i](const size_t j) { return m.get(i, j); }))
+            rows.push_back(i);
+
+    BinaryMatrix island;
+    island.resize(rows.size(), columns.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        island.row_ids.push_back(m.row_ids[rows[i]]);
+        for (size_t j = 0; j < columns.size(); ++j)
+            if (m.get(rows[i], columns[j]))
+                island.set(i, j);
+    }
+    for (const size_t j : columns)
+        island.col_ids.push_back(m.col_ids[j]);
+
+    RBGraph g, gm;
+    build_graph(island, g);
+    maximal_reducible_graph(g, gm, false);
+
+    return ppp_maximal_reducible_graphs(gm);
+}
+
+
+/**
+  @brief Run the PPP algorithm on the maximal reducible graph of \e m by
+  solving each of its conflict components apart.
+
+  The components made of one character are universal, and they are realized
+  first; the other ones are solved by up to exponential::threads threads
+  (one per core if 0), and their characters follow in the order of the
+  components.
+
+  @param[in]  m        Binary matrix
+  @param[out] realized Realized characters
+
+  @return False if m has less than two components with more than one
+  character, or if a component can not be reduced: the heuristics of the
+  algorithm may still reduce the whole graph
+
+  @throws TimeoutError if the deadline of the current thread passes
+*/
+bool solve_conflict_components(const BinaryMatrix &m, std::list<SignedCharacter> &realized) {
+    const std::vector<std::vector<size_t>> components = conflict_components(m);
+
+    std::list<SignedCharacter> universal;
+    std::vector<const std::vector<size_t> *> islands;
+    for (const auto &component : components) {
+        if (component.size() == 1)
+            universal.push_back({"c" + std::to_string(m.col_ids[component.front()]), State::gain});
+        else
+            islands.push_back(&component);
+    }
+
+    if (islands.size() < 2)
+        return false;
+
+    size_t num_threads = exponential::threads;
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min(num_threads, islands.size());
+
+    if (logging::enabled) {
+        // verbosity enabled
+        std::cout << "[INFO] Solving " << islands.size() << " conflict components with "
+                  << num_threads << " threads" << std::endl;
+    }
+
+    std::vector<std::list<SignedCharacter>> partial(islands.size());
+    std::vector<std::exception_ptr> errors(islands.size());
+    std::vector<std::map<std::string, RuleCounters>> counters(num_threads);
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+
+    const Deadline deadline = get_deadline();
+    const GlobalOptions options = get_options();
+
+    auto worker = [&](const size_t id) {
+        DeadlineScope deadline_scope(deadline);
+        OptionsScope options_scope(options);
+
+        for (size_t k = next++; k < islands.size() && !failed; k = next++) {
+            try {
+                partial[k] = solve_island(m, *islands[k]);
+            } catch (...) {
+                errors[k] = std::current_exception();
+                failed = true;
+            }
+        }
+
+        counters[id] = rule_counters();
+    };
+
+    std::vector<std::thread> threads;
+    try {
+        for (size_t id = 0; id < num_threads; ++id)
+            threads.emplace_back(worker, id);
+    } catch (...) {
+        // the threads already started are stopped before the error is reported
+        failed = true;
+        for (auto &thread : threads)
+            thread.join();
+        throw;
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    for (const auto &thread_counters : counters)
+        add_rule_counters(thread_counters);
+
+    std::list<SignedCharacter> lsc = universal;
+    for (size_t k = 0; k < islands.size(); ++k) {
+        if (errors[k]) {
+            try {
+                std::rethrow_exception(errors[k]);
+            } catch (TimeoutError &e) {
+                // the characters realized so far are part of the partial result
+                e.prepend(lsc);
+                throw;
+            } catch (const std::system_error &) {
+                throw;
+            } catch (const std::runtime_error &) {
+                // the island could not be reduced
+                return false;
+            }
+        }
+
+        lsc.splice(lsc.end(), partial[k]);
+    }
+
+    realized = std::move(lsc);
+    return true;
+}
+
+}  // namespace
+
+
+void SolverContext::reset() {
+    reset_matrix(matrix, high_water);
+    reset_matrix(scratch, high_water);
+
+    reduction.realized.clear();
+    reduction.twins.clear();
+
+    reset_buffer(canonical.rows, high_water);
+    reset_buffer(canonical.characters, high_water);
+
+    // the vertices and edges of the graphs are list nodes, freed one by one
+    clear(g);
+    clear(gm);
+}
+
+
+const SolveResult &solve_matrix(SolverContext &context) {
+    // a previous call may have thrown before resetting the context
+    clear(context.g);
+    clear(context.gm);
+    context.reduction.realized.clear();
+    context.reduction.twins.clear();
+
+    SolveResult &result = context.result;
+    result = SolveResult();
+
+    BinaryMatrix &m = context.matrix;
+    RBGraph &g = context.g;
+    MatrixReduction &reduction = context.reduction;
+
+    if (preprocess::enabled) {
+        const size_t num_s = m.num_rows, num_c = m.num_cols;
+        reduce_matrix(m, reduction, context.scratch);
+
+        if (logging::enabled) {
+            // verbosity enabled
+            std::cout << "[INFO] Matrix reduced from " << num_s << "x" << num_c
+                      << " to " << m.num_rows << "x" << m.num_cols << std::endl;
+        }
+    }
+
+    if (!general::enabled && perfect_phylogeny(m, result.realized)) {
+        // no conflicting characters, the graph is not needed
+        if (logging::enabled) {
+            // verbosity enabled
+            std::cout << "[INFO] The matrix has a perfect phylogeny" << std::endl;
+        }
+
+        result.outcome = Outcome::reduced;
+        result.realized = expand_realized(result.realized, reduction);
+        context.reset();
+
+        return result;
+    }
+
+    build_graph(m, g);
+
+    // the reduced graph may have been fully realized by the reduction
+    const bool reduced_to_empty = preprocess::enabled && is_empty(g) && !reduction.realized.empty();
+
+    // the time budget of the matrix starts once it has been read
+    DeadlineScope deadline_scope(
+            timeout::ms == 0 ? Deadline::max()
+                             : std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout::ms));
+
+    // an empty graph is answered by the reduction of the matrix alone, which
+    // the cache does not record, so it is neither looked up nor stored
+    const bool use_cache = !cache::directory.empty() && !is_empty(g);
+
+    // canonical form of the input matrix, used as key of the result cache
+    CanonicalMatrix &cm = context.canonical;
+
+    // the exponential search reduces more graphs, a subset of the rules fewer,
+    // and the preprocessed graphs are keyed by the reduced matrix, so their
+    // results are cached apart
+    const std::string solver = std::string(general::enabled ? "general" : "ppp") +
+                               (exponential::enabled ? "-exponential" : "") +
+                               (preprocess::enabled ? "-preprocess" : "") +
+                               (rules::order.empty() ? "" : "-rules=" + rules::order);
+
+    bool successfully_reduced = false, cached = false;
+    try {
+        // the canonical form takes time too, so it is computed within the budget
+        if (use_cache) {
+            canonical_matrix(g, cm);
+            cached = cache_lookup(cache::directory, solver, cm, successfully_reduced, result.realized);
+        }
+
+        if (!cached) {
+            if (general::enabled) {
+                if (logging::enabled) std::cout << "[INFO] Executing the PPPH algorithm on the Graph" << std::endl;
+
+                result.realized = ppr_general(g);
+                successfully_reduced = (!result.realized.empty() || reduced_to_empty);
+            } else if (solve_conflict_components(m, result.realized)) {
+                successfully_reduced = true;
+            } else {
+                if (logging::enabled) {
+                    // verbosity enabled
+                    std::cout << "[INFO] Extracting the maximal reducible graph..." << std::endl;
+                }
+
+                RBGraph &gm = context.gm;
+                maximal_reducible_graph(g, gm, false);
+
+                if (logging::enabled) {
+                    // verbosity enabled
+                    std::cout << "[INFO] Executing the PPP algorithm on the extracted maximal reducible graph..."
+                              << std::endl;
+                }
+
+                result.realized = ppp_maximal_reducible_graphs(gm);
+                successfully_reduced = true;
+            }
+        }
+    } catch (const TimeoutError &e) {
+        result.outcome = Outcome::timeout;
+        result.phase = e.phase();
+        result.realized = e.realized();
+    } catch (const std::system_error &) {
+        // a failure of the system, which says nothing about the matrix
+        context.reset();
+        throw;
+    } catch (const std::runtime_error &) {
+        // the algorithm could not reduce the graph
+        successfully_reduced = false;
+    } catch (...) {
+        context.reset();
+        throw;
+    }
+
+    if (use_cache && !cached && result.outcome != Outcome::timeout)
+        cache_store(cache::directory, solver, cm, successfully_reduced, result.realized);
+
+    if (result.outcome != Outcome::timeout)
+        result.outcome = (successfully_reduced ? Outcome::reduced : Outcome::not_reduced);
+
+    result.realized = expand_realized(result.realized, reduction);
+    context.reset();
+
+    return result;
+}
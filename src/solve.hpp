@@ -0,0 +1,96 @@
+/**
+ *
+ * @file solve.hpp
+ *
+ * @author Simone Paolo Mottadelli
+ *
+ */
+
+#ifndef SOLVE_HPP
+#define SOLVE_HPP
+
+#include "cache.hpp"
+#include "preprocess.hpp"
+
+//=============================================================================
+// Data structures
+
+
+/**
+  Scoped enumeration type used for the outcome of the algorithm on a matrix
+*/
+enum class Outcome {
+    reduced,      ///< The graph has been reduced
+    not_reduced,  ///< The graph can not be reduced
+    timeout       ///< The time budget ran out
+};
+
+/**
+  @brief Struct used to represent the result of the algorithm on a matrix
+*/
+struct SolveResult {
+    Outcome outcome = Outcome::not_reduced;  ///< Outcome
+    std::list<SignedCharacter> realized{};   ///< Realized characters (until the deadline on timeout)
+    std::string phase{};                     ///< Phase that was running on timeout
+};
+
+/**
+  @brief Class used to keep the buffers of the algorithm from a matrix to the
+  next one
+
+  A caller solving many matrices fills \e matrix and calls solve_matrix on the
+  same context each time: the matrices, the graphs and the canonical matrix
+  are emptied in place, so their memory is allocated once for the largest
+  matrix instead of once per matrix. A buffer whose capacity exceeds
+  \e high_water elements is released when the context is reset, so a single
+  huge matrix does not pin its memory for the following ones.
+*/
+class SolverContext {
+public:
+    BinaryMatrix matrix{};  ///< Matrix to solve, consumed by solve_matrix
+    SolveResult result{};   ///< Result of the last call of solve_matrix
+
+    size_t high_water = size_t(1) << 20;  ///< Capacity past which a buffer is released
+
+    BinaryMatrix scratch{};        ///< Buffer of the reduced matrix
+    MatrixReduction reduction{};   ///< Reduction mapping of matrix
+    CanonicalMatrix canonical{};   ///< Canonical form of g, used as key of the cache
+    RBGraph g{};                   ///< Red-black graph of matrix
+    RBGraph gm{};                  ///< Maximal reducible graph of g
+
+    /**
+      @brief Empty every buffer but \e result in place, and release the ones
+      whose capacity exceeds \e high_water .
+    */
+    void reset();
+};
+
+//=============================================================================
+// Functions
+
+
+/**
+  @brief Run the algorithm selected by the global options on the matrix
+  context.matrix .
+
+  The matrix is reduced first if preprocess::enabled, the result is looked up
+  in and stored to the cache if cache::directory is set, and the algorithm
+  stops after timeout::ms milliseconds if it is set. The realized characters
+  refer to the columns of the matrix.
+
+  The context is reset before returning, so the matrix is consumed.
+
+  A std::runtime_error of the algorithm means that the matrix can not be
+  reduced; any other error (and std::system_error) is not stored in the cache
+  and is thrown again.
+
+  @param[in,out] context Solver context
+
+  @return Result of the algorithm (context.result)
+
+  @throws std::exception if the algorithm fails for a reason other than the
+          matrix
+*/
+const SolveResult &solve_matrix(SolverContext &context);
+
+#endif  // SOLVE_HPP
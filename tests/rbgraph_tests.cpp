@@ -12,6 +12,12 @@
 #include <dirent.h>
 #include "../src/rbgraph.hpp"
 #include "../src/functions.hpp"
+#include "../src/bitgraph.hpp"
+#include "../src/cache.hpp"
+#include "../src/exponential.hpp"
+#include "../src/ppp.hpp"
+#include "../src/preprocess.hpp"
+#include "../src/solve.hpp"
 #include <iostream>
 
 void test_simple_add_vertex() {
@@ -511,6 +517,40 @@ void test_overlap() {
     std::cout << "test_overlap: passed" << std::endl;
 }
 
+void test_overlap_graph() {
+    RBGraph g;
+    std::vector<RBVertex> chars;
+
+    for (size_t i = 0; i < 6; ++i)
+        add_species("s" + std::to_string(i), g);
+    for (size_t j = 0; j < 5; ++j)
+        chars.push_back(add_character("c" + std::to_string(j), g));
+
+    // c0: s0 s1 s2, c1: s2 s3, c2: s0 s1, c3: s3 s4, c4: s5
+    add_edge("s0", "c0", Color::black, g);
+    add_edge("s1", "c0", Color::black, g);
+    add_edge("s2", "c0", Color::black, g);
+    add_edge("s2", "c1", Color::black, g);
+    add_edge("s3", "c1", Color::black, g);
+    add_edge("s0", "c2", Color::black, g);
+    add_edge("s1", "c2", Color::black, g);
+    add_edge("s3", "c3", Color::black, g);
+    add_edge("s4", "c3", Color::black, g);
+    add_edge("s5", "c4", Color::black, g);
+
+    const std::vector<std::vector<size_t>> overlaps = overlap_graph(chars, g);
+    const std::vector<std::vector<size_t>> expected = {{1}, {0, 3}, {}, {1}, {}};
+    assert(overlaps == expected);
+
+    // same pairs of overlaps_character
+    for (size_t i = 0; i < chars.size(); ++i)
+        for (size_t j = 0; j < chars.size(); ++j)
+            assert(overlaps_character(chars[i], chars[j], g) ==
+                   std::binary_search(overlaps[i].begin(), overlaps[i].end(), j));
+
+    std::cout << "test_overlap_graph: passed" << std::endl;
+}
+
 void test_active() {
     RBGraph g;
     RBVertex s1, s2, s3, s4, s5, s6,
@@ -668,6 +708,51 @@ void test_connected() {
     std::cout << "test_connected: passed" << std::endl;
 }
 
+void test_component_index() {
+    RBGraph g;
+    RBVertex v0, v1, v2, v3, v4, v5;
+
+    v0 = add_vertex("v0", Type::character, g);
+    v1 = add_vertex("v1", Type::character, g);
+    v2 = add_vertex("v2", Type::species, g);
+    v3 = add_vertex("v3", Type::character, g);
+    v4 = add_vertex("v4", Type::species, g);
+    v5 = add_vertex("v5", Type::species, g);
+
+    add_edge(v1, v4, Color::red, g);
+    add_edge(v3, v2, g);
+    add_edge(v1, v5, Color::red, g);
+
+    const ComponentIndex &index = component_index(g);
+    ComponentIndex::VertexIter v, v_end;
+
+    assert(index.num_components() == 3);
+    assert(index.component_id(v0) == 0);
+    assert(index.component_id(v1) == 1);
+    assert(index.component_id(v4) == 1);
+    assert(index.component_id(v5) == 1);
+    assert(index.component_id(v2) == 2);
+    assert(index.component_id(v3) == 2);
+
+    // vertices of a component in the order of the vertex list
+    std::tie(v, v_end) = index.component(1);
+    assert(std::vector<RBVertex>(v, v_end) == std::vector<RBVertex>({v1, v4, v5}));
+    std::tie(v, v_end) = index.component(2);
+    assert(std::vector<RBVertex>(v, v_end) == std::vector<RBVertex>({v2, v3}));
+
+    assert(get_comp_vertex(v1, g) == std::list<RBVertex>({v4, v5}));
+    assert(get_comp_vertex(v5, g) == std::list<RBVertex>({v1}));
+    assert(get_comp_vertex(v0, g).empty());
+
+    // the index follows the changes of g
+    add_edge(v3, v5, g);
+    assert(component_index(g).num_components() == 2);
+    assert(get_comp_vertex(v5, g) == std::list<RBVertex>({v1, v3}));
+    assert(get_comp_active_characters(v2, g) == std::list<RBVertex>({v1}));
+
+    std::cout << "test_component_index: passed" << std::endl;
+}
+
 void test_includes() {
     RBGraph g;
     RBVertex s1, s2, s3, s4,
@@ -781,6 +866,267 @@ void test_maximal() {
     std::cout << "test_maximal: passed" << std::endl;
 }
 
+void test_worklists() {
+    RBGraph g;
+    RBVertex s1, s2, s3, c1, c2, c3;
+
+    s1 = add_vertex("s1", Type::species, g);
+    s2 = add_vertex("s2", Type::species, g);
+    s3 = add_vertex("s3", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+    c3 = add_vertex("c3", Type::character, g);
+
+    add_edge(s1, c1, Color::black, g);
+    add_edge(s2, c1, Color::black, g);
+    add_edge(s2, c2, Color::black, g);
+    add_edge(s3, c2, Color::black, g);
+    add_edge(s3, c3, Color::red, g);
+
+    WorklistScope scope(g);
+    Worklists &worklists = scope.worklists();
+
+    assert(get_pending_species(g) == std::list<RBVertex>({s1}));
+    assert(get_active_species(g) == std::list<RBVertex>({s1, s2}));
+    assert(get_active_chars(g) == std::list<RBVertex>({c3}));
+    assert(worklists.list(Worklist::mixed_species) == std::list<RBVertex>({s3}));
+    assert(!all_species_with_red_edges(g));
+
+    // the lists follow the changes of g, in the order of the vertices
+    remove_edge(s2, c1, g);
+    assert(get_pending_species(g) == std::list<RBVertex>({s1, s2}));
+
+    add_edge(s1, c3, Color::red, g);
+    assert(get_pending_species(g) == std::list<RBVertex>({s2}));
+    assert(get_active_species(g) == std::list<RBVertex>({s2}));
+    assert(worklists.size(Worklist::mixed_species) == 2);
+
+    RBVertex s4 = add_vertex("s4", Type::species, g);
+    add_edge(s4, c1, Color::black, g);
+    assert(get_pending_species(g) == std::list<RBVertex>({s2, s4}));
+
+    remove_vertex(s2, g);
+    clear_vertex(c2, g);
+    assert(get_pending_species(g) == std::list<RBVertex>({s4}));
+    assert(get_active_chars(g) == std::list<RBVertex>({c2, c3}));
+    assert(get_active_species(g) == std::list<RBVertex>({s4}));
+
+    std::cout << "test_worklists: passed" << std::endl;
+}
+
+void test_species_hasse() {
+    RBGraph g;
+    RBVertex s1, s2, s3, s4, c1, c2, c3;
+
+    s1 = add_vertex("s1", Type::species, g);
+    s2 = add_vertex("s2", Type::species, g);
+    s3 = add_vertex("s3", Type::species, g);
+    s4 = add_vertex("s4", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+    c3 = add_vertex("c3", Type::character, g);
+
+    add_edge(s1, c1, Color::black, g);
+    add_edge(s2, c1, Color::black, g);
+    add_edge(s2, c2, Color::black, g);
+    add_edge(s3, c1, Color::black, g);
+    add_edge(s3, c2, Color::black, g);
+    add_edge(s3, c3, Color::black, g);
+    add_edge(s4, c2, Color::black, g);
+
+    WorklistScope scope(g);
+    SpeciesHasse &hasse = scope.worklists().hasse();
+
+    assert(hasse.supersets(s1) == std::list<RBVertex>({s2, s3}));
+    assert(hasse.supersets(s4) == std::list<RBVertex>({s2, s3}));
+    assert(hasse.supersets(s3).empty());
+
+    // the diagram follows the changes of g
+    add_edge(s1, c2, Color::black, g);
+    assert(scope.worklists().hasse().supersets(s1) == std::list<RBVertex>({s3}));
+    assert(scope.worklists().hasse().supersets(s4).size() == 3);
+    assert(scope.worklists().hasse().supersets(s4).back() == s3);
+
+    // c3 becomes active, so s3 has the same inactive characters as s2
+    remove_edge(s3, c3, g);
+    add_edge(s2, c3, Color::red, g);
+    assert(scope.worklists().hasse().supersets(s3).empty());
+
+    remove_vertex(s2, g);
+    assert(scope.worklists().hasse().supersets(s4).size() == 2);
+    assert(get_all_minimal_p_active_species(g, true).size() == 1);
+
+    std::cout << "test_species_hasse: passed" << std::endl;
+}
+
+void test_rule_engine() {
+    RBGraph g;
+    RBVertex s1, s2, c1, c2;
+
+    s1 = add_vertex("s1", Type::species, g);
+    s2 = add_vertex("s2", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+
+    add_edge(s1, c1, Color::black, g);
+    add_edge(s2, c1, Color::black, g);
+    add_edge(s2, c2, Color::black, g);
+
+    size_t tests = 0;
+    RuleEngine engine;
+    engine.add_rule(
+            "never",
+            [&tests](const RBGraph &, RBVertex &) { ++tests; return false; },
+            [](RBGraph &, RBVertex) { return std::list<SignedCharacter>(); });
+    engine.add_rule(
+            "pending",
+            [&tests](const RBGraph &g, RBVertex &witness) {
+                ++tests;
+                const std::list<RBVertex> pending_species = get_pending_species(g);
+                if (pending_species.empty())
+                    return false;
+
+                witness = pending_species.front();
+                return true;
+            },
+            [](RBGraph &g, RBVertex witness) { return realize_species(witness, g).first; });
+
+    reset_rule_counters();
+
+    // each rule is tested once, and the witness is passed to the action
+    std::list<SignedCharacter> realized;
+    assert(engine.step(g, realized));
+    assert(tests == 2);
+    assert(realized == std::list<SignedCharacter>({{"c1", State::gain}}));
+    assert(rule_counters().at("never").evaluations == 1);
+    assert(rule_counters().at("never").hits == 0);
+    assert(rule_counters().at("pending").hits == 1);
+
+    // the rules not listed are not tested
+    engine.set_order("never");
+    assert(!engine.step(g, realized));
+    assert(tests == 3);
+    assert(rule_counters().at("pending").evaluations == 1);
+
+    try {
+        engine.set_order("pending,unknown");
+        assert(false);
+    } catch (const std::runtime_error &) {
+    }
+
+    reset_rule_counters();
+    assert(rule_counters().empty());
+
+    std::cout << "test_rule_engine: passed" << std::endl;
+}
+
+void test_maximal_index() {
+    RBGraph g;
+    RBVertex s3, c1, c2, c3, c4, c5, c6, c7;
+
+    add_vertex("s2", Type::species, g);
+    s3 = add_vertex("s3", Type::species, g);
+    add_vertex("s4", Type::species, g);
+    add_vertex("s5", Type::species, g);
+    add_vertex("s6", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+    c3 = add_vertex("c3", Type::character, g);
+    c4 = add_vertex("c4", Type::character, g);
+    c5 = add_vertex("c5", Type::character, g);
+    c6 = add_vertex("c6", Type::character, g);
+    c7 = add_vertex("c7", Type::character, g);
+
+    // same graph of test_maximal
+    add_edge("s2", "c3", Color::black, g);
+    add_edge("s2", "c5", Color::black, g);
+    add_edge("s2", "c6", Color::black, g);
+    add_edge("s3", "c2", Color::black, g);
+    add_edge("s3", "c3", Color::black, g);
+    add_edge("s3", "c4", Color::red, g);
+    add_edge("s4", "c1", Color::black, g);
+    add_edge("s4", "c2", Color::black, g);
+    add_edge("s4", "c4", Color::red, g);
+    add_edge("s5", "c1", Color::black, g);
+    add_edge("s5", "c2", Color::black, g);
+    add_edge("s5", "c3", Color::black, g);
+    add_edge("s5", "c4", Color::red, g);
+    add_edge("s5", "c5", Color::black, g);
+    add_edge("s5", "c7", Color::black, g);
+    add_edge("s6", "c2", Color::black, g);
+    add_edge("s6", "c3", Color::black, g);
+    add_edge("s6", "c5", Color::black, g);
+
+    MaximalIndexScope scope(g);
+    MaximalCharacterIndex &index = scope.index();
+
+    assert(maximal_characters(g) == std::list<RBVertex>({c2, c3}));
+    assert(index.is_maximal(c2) && !index.is_maximal(c5) && !index.is_maximal(c4));
+    assert(index.maximal_containing(c5) == c3);
+    assert(index.maximal_containing(c1) == c2);
+    assert(index.maximal_containing(c4) == nullptr);
+
+    // S(c3) = S(c5) = {s2, s5, s6}: the first one in the graph is maximal
+    remove_vertex(s3, g);
+    assert(maximal_characters(g) == std::list<RBVertex>({c2, c3}));
+    assert(index.maximal_containing(c5) == c3);
+
+    // c5 replaces c3, and contains c6
+    realize_character({"c3", State::gain}, g);
+    assert(maximal_characters(g) == std::list<RBVertex>({c2, c5}));
+    assert(index.maximal_containing(c6) == c5);
+
+    // the index gives the same characters of a graph without index
+    RBGraph g_copy;
+    copy_graph(g, g_copy);
+    std::list<std::string> names, names_copy;
+    for (RBVertex v : maximal_characters(g))
+        names.push_back(g[v].name);
+    for (RBVertex v : maximal_characters(g_copy))
+        names_copy.push_back(g_copy[v].name);
+    assert(names == names_copy);
+
+    // a new black edge is not tracked: the index is built again
+    add_edge("s4", "c7", Color::black, g);
+    assert(index.maximal_containing(c7) == c2);
+
+    std::cout << "test_maximal_index: passed" << std::endl;
+}
+
+void test_derived_graphs() {
+    RBGraph g;
+    add_vertex("s1", Type::species, g);
+    add_vertex("s2", Type::species, g);
+    add_vertex("c1", Type::character, g);
+    add_vertex("c2", Type::character, g);
+    add_edge("s1", "c1", Color::black, g);
+    add_edge("s1", "c2", Color::black, g);
+    add_edge("s2", "c1", Color::black, g);
+
+    // each change of g increases its version
+    const size_t v = version(g);
+    remove_edge("s2", "c1", g);
+    assert(version(g) > v);
+    add_edge("s2", "c1", Color::black, g);
+
+    DerivedGraphs derived(g);
+
+    // the skeleton (c1 and s1, s2) is built once while g does not change
+    const size_t skeleton = version(derived.skeleton());
+    assert(num_characters(derived.skeleton()) == 1);
+    assert(num_species(derived.skeleton()) == 2);
+    assert(version(derived.skeleton()) == skeleton);
+    derived.sources();
+    assert(version(derived.skeleton()) == skeleton);
+
+    // and built again when g changes: s1 c2 are left
+    realize_character({"c1", State::gain}, g);
+    assert(version(derived.skeleton()) != skeleton);
+    assert(num_species(derived.skeleton()) == 1);
+
+    std::cout << "test_derived_graphs: passed" << std::endl;
+}
+
 void test_p_active() {
     // CASE: no active characters - 3 species with increasing different degree - isolated nodes
     RBGraph g;
@@ -1027,6 +1373,50 @@ void test_realize() {
     std::cout << "test_realize: passed" << std::endl;
 }
 
+void test_realize_split() {
+    RBGraph g, g1;
+    RBVertex s1, s2, s3, c1, c2, c3;
+
+    s1 = add_vertex("s1", Type::species, g);
+    s2 = add_vertex("s2", Type::species, g);
+    s3 = add_vertex("s3", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+    c3 = add_vertex("c3", Type::character, g);
+
+    add_edge(s1, c1, g);
+    add_edge(s2, c1, g);
+    add_edge(s2, c2, g);
+    add_edge(s3, c2, g);
+    add_edge(s1, c3, g);
+
+    copy_graph(g, g1);
+
+    // c1+ splits the component, then c3+ is realized in { s1, c3 } only
+    std::list<SignedCharacter> lsc;
+    bool feasible;
+    std::tie(lsc, feasible) = realize({{"c1", State::gain}, {"c3", State::gain}}, g);
+
+    assert(feasible);
+    assert(lsc.size() == 2);
+    assert(!exists("s1", g) && !exists("c3", g));
+    assert(num_species(g) == 2 && num_characters(g) == 2);
+    assert(num_edges(g) == 3);
+    assert(is_red(get_edge(s3, c1, g), g));
+
+    realize_character({"c1", State::gain}, g1);
+    realize_character({"c3", State::gain}, g1);
+    assert(num_vertices(g) == num_vertices(g1));
+    assert(num_edges(g) == num_edges(g1));
+
+    // c2- is not feasible, as c2 is inactive
+    std::tie(lsc, feasible) = realize({{"c2", State::lose}}, g);
+    assert(!feasible && lsc.empty());
+    assert(num_edges(g) == 3);
+
+    std::cout << "test_realize_split: passed" << std::endl;
+}
+
 void test_realize_character() {
     RBGraph g;
     RBVertex s1, s2, s3, s4, s5,
@@ -1131,6 +1521,44 @@ void test_universal() {
     std::cout << "test_universal: passed" << std::endl;
 }
 
+void test_universal_characters() {
+    RBGraph g;
+    RBVertex s1, s2, s3, c1, c2, c3, c4, c5;
+
+    s1 = add_vertex("s1", Type::species, g);
+    s2 = add_vertex("s2", Type::species, g);
+    s3 = add_vertex("s3", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+    c3 = add_vertex("c3", Type::character, g);
+    c4 = add_vertex("c4", Type::character, g);
+    c5 = add_vertex("c5", Type::character, g);
+
+    for (RBVertex s : {s1, s2, s3}) {
+        add_edge(s, c1, Color::black, g);
+        add_edge(s, c2, Color::red, g);
+    }
+    add_edge(s1, c3, Color::black, g);
+    add_edge(s2, c4, Color::black, g);
+    add_edge(s3, c5, Color::black, g);
+
+    assert(universal_characters(g) == std::list<SignedCharacter>(
+            {{"c1", State::gain}, {"c2", State::lose}}));
+
+    // c3, c4 and c5 are universal once c1 and c2 are realized
+    std::list<SignedCharacter> lsc;
+    bool realized;
+    std::tie(lsc, realized) = realize_red_univ_and_univ_chars(g);
+
+    assert(realized);
+    assert(lsc == std::list<SignedCharacter>(
+            {{"c1", State::gain}, {"c2", State::lose}, {"c3", State::gain},
+             {"c4", State::gain}, {"c5", State::gain}}));
+    assert(is_empty(g));
+
+    std::cout << "test_universal_characters: passed" << std::endl;
+}
+
 void test_is_degenerate() {
     RBGraph g;
     RBVertex s1, s2, c1, c2, c3, c4, c5, s3;
@@ -1316,6 +1744,13 @@ void test_minimal_form_graph() {
     assert(exists(g[c3].name, gmf));
     assert(exists(g[c4].name, gmf));
 
+    // the characters follow the order of g, not the order of their addresses
+    std::vector<std::string> characters;
+    for (RBVertex v : gmf.m_vertices)
+        if (is_character(v, gmf))
+            characters.push_back(gmf[v].name);
+    assert(characters == std::vector<std::string>({"c1", "c2", "c3", "c4"}));
+
     std::cout << "test_minimal_form_graph: passed" << std::endl;
 }
 
@@ -1364,10 +1799,60 @@ void test_get_matrix_representation() {
     std::cout << "test_get_matrix_representation: passed" << std::endl;
 }
 
+void test_get_sparse_representation() {
+    RBGraph g;
+    std::vector<RBVertex> characters;
+    std::vector<std::vector<size_t>> rows;
+
+    add_vertex("s1", Type::species, g);
+    add_vertex("c1", Type::character, g);
+    add_vertex("s2", Type::species, g);
+    add_vertex("c2", Type::character, g);
+    add_vertex("c3", Type::character, g);
+    add_vertex("s3", Type::species, g);
+    add_edge("s1", "c3", Color::black, g);
+    add_edge("s2", "c1", Color::black, g);
+    add_edge("s2", "c2", Color::black, g);
+    add_edge("s3", "c2", Color::red, g);
+
+    get_sparse_representation(g, characters, rows);
+
+    assert(characters.size() == 3);
+    assert(characters[0] == get_vertex("c1", g));
+    assert(characters[1] == get_vertex("c2", g));
+    assert(characters[2] == get_vertex("c3", g));
+
+    // same matrix as get_matrix_representation, red edges excluded
+    bool **m = new bool *[3];
+    for (int i = 0; i < 3; ++i) {
+        m[i] = new bool[3];
+    }
+    get_matrix_representation(g, m, 3, 3);
+
+    assert(rows.size() == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        size_t ones = 0;
+        for (size_t j = 0; j < 3; ++j)
+            ones += m[i][j];
+        assert(rows[i].size() == ones);
+        for (size_t j : rows[i])
+            assert(m[i][j]);
+    }
+    assert(rows[2].empty());
+
+    for (int i = 0; i < 3; ++i) {
+        delete[] m[i];
+    }
+    delete[] m;
+
+    std::cout << "test_get_sparse_representation: passed" << std::endl;
+}
+
 void test_01_property() {
     RBGraph g;
     read_graph("test_01_property1.txt", g);
     assert(!has_consecutive_ones_property(g));
+    clear(g);
     read_graph("test_01_property2.txt", g);
     assert(has_consecutive_ones_property(g));
     clear(g);
@@ -1432,6 +1917,717 @@ void test_01_property() {
     std::cout << "test_01_property: passed" << std::endl;
 }
 
+void test_01_property_engines() {
+    // every species must have its inactive characters consecutive in order
+    auto is_consecutive = [](const std::list<RBVertex> &order, const RBGraph &g) {
+        std::map<RBVertex, size_t> position;
+        for (RBVertex c : order)
+            position[c] = position.size();
+
+        for (RBVertex s : g.m_vertices) {
+            if (!is_species(s, g))
+                continue;
+
+            std::list<RBVertex> chars = get_adj_inactive_characters(s, g);
+            if (chars.empty())
+                continue;
+
+            size_t min_pos = order.size(), max_pos = 0;
+            for (RBVertex c : chars) {
+                min_pos = std::min(min_pos, position.at(c));
+                max_pos = std::max(max_pos, position.at(c));
+            }
+            if (max_pos - min_pos + 1 != chars.size())
+                return false;
+        }
+        return true;
+    };
+
+    RBGraph g;
+    std::list<RBVertex> order;
+
+    // c1 c2 c3 c4 c5
+    //  1  1  0  0  0
+    //  0  1  1  1  0
+    //  0  0  0  1  1
+    //  0  0  1  1  0
+    add_vertex("s1", Type::species, g);
+    add_vertex("s2", Type::species, g);
+    add_vertex("s3", Type::species, g);
+    add_vertex("s4", Type::species, g);
+    add_vertex("c1", Type::character, g);
+    add_vertex("c2", Type::character, g);
+    add_vertex("c3", Type::character, g);
+    add_vertex("c4", Type::character, g);
+    add_vertex("c5", Type::character, g);
+    add_edge("s1", "c1", Color::black, g);
+    add_edge("s1", "c2", Color::black, g);
+    add_edge("s2", "c2", Color::black, g);
+    add_edge("s2", "c3", Color::black, g);
+    add_edge("s2", "c4", Color::black, g);
+    add_edge("s3", "c4", Color::black, g);
+    add_edge("s3", "c5", Color::black, g);
+    add_edge("s4", "c3", Color::black, g);
+    add_edge("s4", "c4", Color::black, g);
+
+    assert(has_consecutive_ones_property(g, order, C1PEngine::pqtree));
+    assert(order.size() == num_characters(g));
+    assert(is_consecutive(order, g));
+    assert(has_consecutive_ones_property(g, order, C1PEngine::lexbfs));
+    assert(order.size() == num_characters(g));
+    assert(is_consecutive(order, g));
+
+    // scramble the columns so that no identity order works
+    add_edge("s3", "c1", Color::black, g);
+    assert(!has_consecutive_ones_property(g, order, C1PEngine::pqtree));
+    assert(order.empty());
+    assert(!has_consecutive_ones_property(g, C1PEngine::lexbfs));
+
+    // red edges are not part of the matrix
+    remove_edge("s3", "c1", g);
+    add_vertex("c6", Type::character, g);
+    add_edge("s1", "c6", Color::red, g);
+    add_edge("s3", "c6", Color::red, g);
+    assert(has_consecutive_ones_property(g, order, C1PEngine::pqtree));
+    assert(is_consecutive(order, g));
+
+    clear(g);
+    read_graph("test_01_property2.txt", g);
+    assert(has_consecutive_ones_property(g, order, C1PEngine::pqtree));
+    assert(is_consecutive(order, g));
+
+    // read_graph does not clear g, so the matrix of test_01_property1.txt is
+    // added as a second block: its 3-cycle has no consecutive ones ordering
+    // (the LexBFS engine does not detect it)
+    read_graph("test_01_property1.txt", g);
+    assert(!has_consecutive_ones_property(g, C1PEngine::pqtree));
+
+    std::cout << "test_01_property_engines: passed" << std::endl;
+}
+
+void test_canonical_matrix() {
+    RBGraph g1, g2;
+    CanonicalMatrix cm1, cm2;
+
+    // s1: c1 c2, s2: c2 c3, s3: c3 (c1 red)
+    add_vertex("s1", Type::species, g1);
+    add_vertex("s2", Type::species, g1);
+    add_vertex("s3", Type::species, g1);
+    add_vertex("c1", Type::character, g1);
+    add_vertex("c2", Type::character, g1);
+    add_vertex("c3", Type::character, g1);
+    add_edge("s1", "c1", Color::black, g1);
+    add_edge("s1", "c2", Color::black, g1);
+    add_edge("s2", "c2", Color::black, g1);
+    add_edge("s2", "c3", Color::black, g1);
+    add_edge("s3", "c3", Color::black, g1);
+    add_edge("s3", "c1", Color::red, g1);
+
+    // same matrix, with species and characters permuted and renamed
+    add_vertex("c6", Type::character, g2);
+    add_vertex("s5", Type::species, g2);
+    add_vertex("c4", Type::character, g2);
+    add_vertex("s6", Type::species, g2);
+    add_vertex("c5", Type::character, g2);
+    add_vertex("s4", Type::species, g2);
+    add_edge("s5", "c6", Color::black, g2);
+    add_edge("s5", "c4", Color::black, g2);
+    add_edge("s6", "c4", Color::black, g2);
+    add_edge("s6", "c5", Color::black, g2);
+    add_edge("s4", "c5", Color::black, g2);
+    add_edge("s4", "c6", Color::red, g2);
+
+    canonical_matrix(g1, cm1);
+    canonical_matrix(g2, cm2);
+
+    assert(cm1.rows == cm2.rows);
+    assert(fingerprint(cm1, "ppp") == fingerprint(cm2, "ppp"));
+    assert(fingerprint(cm1, "ppp") != fingerprint(cm1, "general"));
+
+    // each column is mapped to the corresponding character
+    for (size_t j = 0; j < cm1.characters.size(); ++j) {
+        const std::string c1 = cm1.characters[j], c2 = cm2.characters[j];
+        assert((c1 == "c1" && c2 == "c6") || (c1 == "c2" && c2 == "c4") ||
+               (c1 == "c3" && c2 == "c5"));
+    }
+
+    // a different matrix has a different canonical form
+    remove_edge("s4", "c6", g2);
+    add_edge("s4", "c6", Color::black, g2);
+    canonical_matrix(g2, cm2);
+    assert(cm1.rows != cm2.rows);
+
+    std::cout << "test_canonical_matrix: passed" << std::endl;
+}
+
+void test_memo_components() {
+    // three copies of the same clade, with permuted names:
+    // s(3k+1): c(2k+1) c(2k+2), s(3k+2): c(2k+1), s(3k+3): c(2k+2)
+    RBGraph g, g_copy;
+    for (size_t k = 0; k < 3; ++k) {
+        const std::string s1 = "s" + std::to_string(3 * k + 1),
+                s2 = "s" + std::to_string(3 * k + 2),
+                s3 = "s" + std::to_string(3 * k + 3),
+                c1 = "c" + std::to_string(2 * k + 1),
+                c2 = "c" + std::to_string(2 * k + 2);
+        add_vertex(s1, Type::species, g);
+        add_vertex(s2, Type::species, g);
+        add_vertex(s3, Type::species, g);
+        add_vertex(c1, Type::character, g);
+        add_vertex(c2, Type::character, g);
+        add_edge(s1, c1, Color::black, g);
+        add_edge(s1, c2, Color::black, g);
+        add_edge(s2, (k == 1 ? c2 : c1), Color::black, g);
+        add_edge(s3, (k == 1 ? c1 : c2), Color::black, g);
+    }
+
+    size_t length = 0;
+    for (const bool enabled : {false, true}) {
+        memo::enabled = enabled;
+
+        RBGraph gm;
+        copy_graph(g, gm);
+        std::list<SignedCharacter> lsc = ppp_maximal_reducible_graphs(gm);
+
+        // the realization of the signed characters gives an empty graph
+        copy_graph(g, g_copy);
+        for (SignedCharacter sc : lsc)
+            realize_character(sc, g_copy);
+
+        assert(is_empty(g_copy));
+
+        // the memo table only renames the sequences of the repeated clades
+        if (enabled)
+            assert(lsc.size() == length);
+        length = lsc.size();
+    }
+
+    std::cout << "test_memo_components: passed" << std::endl;
+}
+
+void test_ppp_exponential() {
+    // s1: c1 c2, s2: c1, s3: c2, s4: c3 c4, s5: c3 c5, s6: c4 c5
+    RBGraph g, g_copy;
+    const std::vector<std::pair<std::string, std::string>> edges = {
+            {"s1", "c1"}, {"s1", "c2"}, {"s2", "c1"}, {"s3", "c2"},
+            {"s4", "c3"}, {"s4", "c4"}, {"s5", "c3"}, {"s5", "c5"},
+            {"s6", "c4"}, {"s6", "c5"}
+    };
+    for (size_t i = 1; i <= 6; ++i)
+        add_vertex("s" + std::to_string(i), Type::species, g);
+    for (size_t i = 1; i <= 5; ++i)
+        add_vertex("c" + std::to_string(i), Type::character, g);
+    for (const auto &e : edges)
+        add_edge(e.first, e.second, Color::black, g);
+
+    for (const size_t threads : {1, 4}) {
+        exponential::threads = threads;
+
+        // the realization of the signed characters gives an empty graph
+        copy_graph(g, g_copy);
+        std::list<SignedCharacter> lsc = ppp_exponential(g_copy);
+        assert(is_empty(g_copy));
+
+        copy_graph(g, g_copy);
+        for (SignedCharacter sc : lsc)
+            realize_character(sc, g_copy);
+
+        assert(is_empty(g_copy));
+    }
+
+    // red sigma-graph: s1 -- c1 -- s2 -- c2 -- s3, all red
+    RBGraph h;
+    add_vertex("s1", Type::species, h);
+    add_vertex("s2", Type::species, h);
+    add_vertex("s3", Type::species, h);
+    add_vertex("c1", Type::character, h);
+    add_vertex("c2", Type::character, h);
+    add_edge("s1", "c1", Color::red, h);
+    add_edge("s2", "c1", Color::red, h);
+    add_edge("s2", "c2", Color::red, h);
+    add_edge("s3", "c2", Color::red, h);
+
+    bool thrown = false;
+    try {
+        ppp_exponential(h);
+    } catch (const std::runtime_error &e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // the rules lead to a graph with no reduction, while the matrix is
+    // reduced by c2+ c1+ c0+ c7+ c1- c8+ c0- c7- c8-
+    BinaryMatrix m;
+    std::istringstream is("12 9\n"
+                          "0 0 0 0 0 0 0 1 0\n0 0 0 0 1 0 0 0 1\n1 0 0 0 0 0 0 1 1\n"
+                          "0 1 0 0 0 0 0 0 0\n0 0 1 0 0 0 0 0 0\n0 0 0 0 0 1 0 1 1\n"
+                          "1 1 0 0 0 0 0 1 0\n0 0 0 0 0 0 0 0 0\n0 0 0 0 0 1 0 1 0\n"
+                          "0 0 0 0 0 1 0 1 0\n0 0 0 0 1 0 0 0 1\n1 1 0 0 0 0 0 0 0\n");
+    read_matrix(is, m);
+    RBGraph k, km, km_copy;
+    build_graph(m, k);
+    maximal_reducible_graph(k, km);
+
+    exponential::enabled = true;
+    for (const bool bits : {false, true}) {
+        bitgraph::enabled = bits;
+
+        copy_graph(km, km_copy);
+        std::list<SignedCharacter> lsc = ppp_maximal_reducible_graphs(km_copy);
+        assert(is_empty(km_copy));
+
+        copy_graph(km, km_copy);
+        assert(realize(lsc, km_copy).second);
+        assert(is_empty(km_copy));
+    }
+    bitgraph::enabled = false;
+    exponential::enabled = false;
+
+    exponential::threads = 0;
+
+    std::cout << "test_ppp_exponential: passed" << std::endl;
+}
+
+
+void test_bitgraph() {
+    // s1: c1 c2, s2: c1, s3: c2 (red), s4: c3
+    RBGraph g;
+    for (size_t i = 1; i <= 4; ++i)
+        add_vertex("s" + std::to_string(i), Type::species, g);
+    for (size_t i = 1; i <= 3; ++i)
+        add_vertex("c" + std::to_string(i), Type::character, g);
+    add_edge("s1", "c1", Color::black, g);
+    add_edge("s1", "c2", Color::red, g);
+    add_edge("s2", "c1", Color::black, g);
+    add_edge("s3", "c2", Color::red, g);
+    add_edge("s4", "c3", Color::black, g);
+
+    BitGraph b;
+    build_bitgraph(g, b);
+    assert(num_species(b) == 4 && num_characters(b) == 3);
+    assert(is_inactive(get_character("c1", b), b));
+    assert(is_active(get_character("c2", b), b));
+
+    // c3 is universal in the component of s4, c2 is red-universal in its own
+    assert(is_universal(get_character("c3", b), b));
+    assert(!is_universal(get_character("c1", b), b));
+    assert(!is_red_universal(get_character("c2", b), b));
+    assert(connected_components(b).size() == 2);
+
+    // realizing c1+ complements its column: s1 and s2 lose c1, s3 gains it red
+    assert(realize_character({"c1", State::gain}, b).second);
+    RBGraph h;
+    build_graph(b, h);
+    assert(!exists("s1", "c1", h));
+    assert(exists("s3", "c1", h) && is_red(get_edge(get_vertex("s3", h), get_vertex("c1", h), h), h));
+
+    // s2 is left with no edges, and every species of c1 has c2
+    assert(num_species(b) == 3);
+    assert(!has_red_sigmagraph(b));
+
+    // s1 gets the edges of s3, so it is kept in place of s3
+    b.add_edge(0, get_character("c1", b), Color::red);
+    remove_duplicate_species(b);
+    assert(b.species_names == std::vector<std::string>({"s1", "s4"}));
+
+    // the exponential search reduces g on bit graphs too
+    bitgraph::enabled = true;
+    RBGraph g_copy;
+    copy_graph(g, g_copy);
+    const std::list<SignedCharacter> lsc = ppp_exponential(g_copy);
+    assert(is_empty(g_copy));
+    bitgraph::enabled = false;
+
+    copy_graph(g, g_copy);
+    for (const SignedCharacter &sc : lsc)
+        assert(realize_character(sc, g_copy).second);
+    assert(is_empty(g_copy));
+
+    std::cout << "test_bitgraph: passed" << std::endl;
+}
+
+void test_deadline() {
+    // c1 is universal, s1: c1 c2 c3, s2: c1 c2, s3: c1 c3
+    RBGraph g;
+    add_vertex("s1", Type::species, g);
+    add_vertex("s2", Type::species, g);
+    add_vertex("s3", Type::species, g);
+    add_vertex("c1", Type::character, g);
+    add_vertex("c2", Type::character, g);
+    add_vertex("c3", Type::character, g);
+    add_edge("s1", "c1", Color::black, g);
+    add_edge("s1", "c2", Color::black, g);
+    add_edge("s1", "c3", Color::black, g);
+    add_edge("s2", "c1", Color::black, g);
+    add_edge("s2", "c2", Color::black, g);
+    add_edge("s3", "c1", Color::black, g);
+    add_edge("s3", "c3", Color::black, g);
+
+    bool thrown = false;
+    {
+        // the deadline has already passed
+        DeadlineScope deadline_scope(std::chrono::steady_clock::now());
+
+        try {
+            ppr_general(g);
+        } catch (const TimeoutError &e) {
+            thrown = true;
+
+            // the universal character is realized before the first checkpoint
+            assert(e.phase() == "duplicate species");
+            assert(e.realized().size() == 1);
+            assert(e.realized().front().character == "c1");
+            assert(e.realized().front().state == State::gain);
+        }
+    }
+    assert(thrown);
+
+    // the scope restores the previous deadline
+    assert(get_deadline() == Deadline::max());
+    check_deadline("test");
+
+    std::cout << "test_deadline: passed" << std::endl;
+}
+
+void test_ppp_solve() {
+    // s1: c3 c4 c5, s2: c1 c2 c3, s3: c1 c2 c4 c5, s4: c4 c5
+    const std::vector<std::vector<size_t>> rows = {{2, 3, 4}, {0, 1, 2}, {0, 1, 3, 4}, {3, 4}};
+
+    ppp::DenseMatrix dense(4, 5);
+    ppp::SparseMatrix sparse;
+    sparse.num_species = 4;
+    sparse.num_characters = 5;
+    sparse.rows = rows;
+    for (size_t i = 0; i < rows.size(); ++i)
+        for (size_t j : rows[i])
+            dense.set(i, j);
+
+    ppp::Options options;
+    options.general = true;
+    options.exponential = true;
+
+    const ppp::Result r_dense = ppp::solve(dense, options), r_sparse = ppp::solve(sparse, options);
+    assert(r_dense.status == ppp::Status::reduced);
+    assert(r_sparse.status == ppp::Status::reduced);
+    assert(r_dense.realized.size() == r_sparse.realized.size());
+
+    // the same matrix stored by columns, read in place with its strides
+    std::vector<uint8_t> bytes(4 * 5, 0);
+    for (size_t i = 0; i < rows.size(); ++i)
+        for (size_t j : rows[i])
+            bytes[j * 4 + i] = 1;
+
+    ppp::ByteMatrix byte_matrix;
+    byte_matrix.data = bytes.data();
+    byte_matrix.num_species = 4;
+    byte_matrix.num_characters = 5;
+    byte_matrix.row_stride = 1;
+    byte_matrix.col_stride = 4;
+
+    const ppp::Result r_bytes = ppp::solve(byte_matrix, options);
+    assert(r_bytes.status == ppp::Status::reduced);
+    assert(r_bytes.realized.size() == r_dense.realized.size());
+
+    // the realization of the signed characters gives an empty graph
+    RBGraph g;
+    for (size_t i = 0; i < rows.size(); ++i)
+        add_vertex("s" + std::to_string(i), Type::species, g);
+    for (size_t j = 0; j < 5; ++j)
+        add_vertex("c" + std::to_string(j), Type::character, g);
+    for (size_t i = 0; i < rows.size(); ++i)
+        for (size_t j : rows[i])
+            add_edge("s" + std::to_string(i), "c" + std::to_string(j), Color::black, g);
+
+    for (const ppp::SignedCharacter &sc : r_dense.realized)
+        realize_character({"c" + std::to_string(sc.character), sc.gain ? State::gain : State::lose}, g);
+
+    assert(is_empty(g));
+
+    // the options of the call do not change the options of the thread
+    assert(!general::enabled && !exponential::enabled);
+
+    bool thrown = false;
+    try {
+        sparse.rows[0].push_back(5);
+        ppp::solve(sparse);
+    } catch (const std::runtime_error &e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "test_ppp_solve: passed" << std::endl;
+}
+
+void test_reduce_matrix() {
+    BinaryMatrix m;
+    MatrixReduction r;
+
+    //     c0 c1 c2 c3 c4
+    // s0:  1  1  1  0  0
+    // s1:  1  1  1  0  0
+    // s2:  1  0  0  1  0
+    // s3:  0  0  0  0  0
+    // s4:  1  1  1  0  0
+    m.resize(5, 5);
+    m.row_ids = {0, 1, 2, 3, 4};
+    m.col_ids = {0, 1, 2, 3, 4};
+    for (size_t i : {0, 1, 2, 4})
+        m.set(i, 0);
+    for (size_t i : {0, 1, 4}) {
+        m.set(i, 1);
+        m.set(i, 2);
+    }
+    m.set(2, 3);
+
+    reduce_matrix(m, r);
+
+    // s3 and c4 are empty, c0 is universal once s3 is dropped, c2 is a
+    // duplicate of c1, s1 and s4 are duplicates of s0
+    assert(m.num_rows == 2 && m.num_cols == 2);
+    assert(m.row_ids == std::vector<size_t>({0, 2}));
+    assert(m.col_ids == std::vector<size_t>({1, 3}));
+    assert(m.get(0, 0) && !m.get(0, 1));
+    assert(!m.get(1, 0) && m.get(1, 1));
+
+    assert(r.realized.size() == 1);
+    assert(r.realized.front() == SignedCharacter({"c0", State::gain}));
+    assert(r.twins.size() == 1);
+    assert(r.twins.at("c1") == std::list<std::string>({"c2"}));
+
+    // the reduced graph keeps the original names
+    RBGraph g;
+    build_graph(m, g);
+    assert(exists("s2", g) && exists("c3", g) && !exists("c0", g));
+
+    const std::list<SignedCharacter> lsc = expand_realized({
+            {"c1", State::gain}, {"c3", State::gain}, {"c1", State::lose}
+    }, r);
+    const std::list<SignedCharacter> expected = {
+            {"c0", State::gain}, {"c1", State::gain}, {"c2", State::gain},
+            {"c3", State::gain}, {"c1", State::lose}, {"c2", State::lose}
+    };
+    assert(lsc == expected);
+
+    std::cout << "test_reduce_matrix: passed" << std::endl;
+}
+
+void test_perfect_phylogeny() {
+    BinaryMatrix m;
+    std::list<SignedCharacter> realized;
+
+    //     c0 c1 c2 c3 c4
+    // s0:  1  0  1  0  1
+    // s1:  1  0  0  0  1
+    // s2:  0  1  0  0  0
+    // s3:  0  1  0  1  0
+    // s4:  0  1  0  1  0
+    m.resize(5, 5);
+    m.row_ids = {0, 1, 2, 3, 4};
+    m.col_ids = {0, 1, 2, 3, 4};
+    for (size_t i : {0, 1}) {
+        m.set(i, 0);
+        m.set(i, 4);
+    }
+    m.set(0, 2);
+    for (size_t i : {2, 3, 4})
+        m.set(i, 1);
+    for (size_t i : {3, 4})
+        m.set(i, 3);
+
+    // c1 has the most ones, c4 is a duplicate of c0, c2 and c3 are not maximal
+    assert(perfect_phylogeny(m, realized));
+    assert(realized == std::list<SignedCharacter>({{"c1", State::gain}, {"c0", State::gain}}));
+
+    RBGraph g, gm;
+    build_graph(m, g);
+    maximal_reducible_graph(g, gm, false);
+    assert(ppp_maximal_reducible_graphs(gm) == realized);
+
+    // c2 and c3 conflict
+    m.set(0, 3);
+    assert(!perfect_phylogeny(m, realized));
+
+    // the matrices with active characters take the general path
+    m.clear();
+    m.resize(1, 1);
+    m.row_ids = {0};
+    m.col_ids = {0};
+    m.set(0, 0);
+    m.active = {0};
+    assert(!perfect_phylogeny(m, realized));
+
+    std::cout << "test_perfect_phylogeny: passed" << std::endl;
+}
+
+void test_conflict_components() {
+    BinaryMatrix m;
+
+    //     c0 c1 c2 c3 c4 c5
+    // s0:  1  0  0  0  0  1
+    // s1:  1  1  0  0  0  0
+    // s2:  0  1  0  0  0  0
+    // s3:  0  0  1  0  0  0
+    // s4:  0  0  1  1  0  0
+    // s5:  0  0  0  1  0  0
+    // s6:  0  0  0  0  1  0
+    m.resize(7, 6);
+    m.row_ids = {0, 1, 2, 3, 4, 5, 6};
+    m.col_ids = {0, 1, 2, 3, 4, 5};
+    for (const auto &one : std::vector<std::pair<size_t, size_t>>({
+            {0, 0}, {1, 0}, {1, 1}, {2, 1}, {3, 2}, {4, 2}, {4, 3}, {5, 3}, {6, 4}, {0, 5}}))
+        m.set(one.first, one.second);
+
+    // c5 is not maximal, c4 conflicts with no character
+    const std::vector<std::vector<size_t>> components = conflict_components(m);
+    assert(components == std::vector<std::vector<size_t>>({{0, 1}, {2, 3}, {4}}));
+
+    // the two components with conflicts are solved apart, after c4
+    SolverContext context;
+    context.matrix = m;
+    const SolveResult &result = solve_matrix(context);
+    assert(result.outcome == Outcome::reduced);
+    assert(result.realized.front() == SignedCharacter({"c4", State::gain}));
+
+    RBGraph g, gm;
+    build_graph(m, g);
+    maximal_reducible_graph(g, gm, false);
+    for (const SignedCharacter &sc : result.realized) {
+        assert(realize_character(sc, gm).second);
+        remove_singletons(gm);
+    }
+    assert(is_empty(gm));
+
+    std::cout << "test_conflict_components: passed" << std::endl;
+}
+
+void test_solver_context() {
+    SolverContext context;
+
+    // s0: c0 c1 c2, s1: c0 c1, s2: c0 c2, s3: c3
+    std::istringstream first("4 4\n1 1 1 0\n1 1 0 0\n1 0 1 0\n0 0 0 1\n");
+    read_matrix(first, context.matrix);
+    assert(solve_matrix(context).outcome == Outcome::reduced);
+    assert(context.result.realized.size() == 2);
+
+    // the buffers are emptied in place
+    const size_t capacity = context.matrix.rows.capacity();
+    assert(capacity > 0 && context.matrix.num_rows == 0);
+    assert(is_empty(context.g) && is_empty(context.gm));
+
+    // the second matrix is smaller, so it fits in the same buffers
+    std::istringstream second("3 3\n1 1 0\n0 1 1\n1 0 1\n");
+    read_matrix(second, context.matrix);
+    assert(context.matrix.rows.capacity() == capacity);
+    assert(solve_matrix(context).outcome == Outcome::reduced);
+    assert(context.result.realized.size() == 5);
+
+    // a buffer past the high-water mark is released
+    context.high_water = 0;
+    std::istringstream third("4 4\n1 1 1 0\n1 1 0 0\n1 0 1 0\n0 0 0 1\n");
+    read_matrix(third, context.matrix);
+    assert(solve_matrix(context).outcome == Outcome::reduced);
+    assert(context.matrix.rows.capacity() == 0);
+
+    std::cout << "test_solver_context: passed" << std::endl;
+}
+
+// remove the directory and the files in it
+void remove_directory(const std::string &directory) {
+    DIR *dir = opendir(directory.c_str());
+    while (dirent *entry = readdir(dir))
+        if (entry->d_name[0] != '.')
+            remove((directory + "/" + entry->d_name).c_str());
+    closedir(dir);
+    rmdir(directory.c_str());
+}
+
+void test_cache_preprocess() {
+    char directory[] = "/tmp/ppp_cache_XXXXXX";
+    assert(mkdtemp(directory) != nullptr);
+
+    general::enabled = true;
+    preprocess::enabled = true;
+    cache::directory = directory;
+
+    // the all-zero matrix is reduced to the empty graph, which is not reduced
+    SolverContext context;
+    std::istringstream zeros("2 2\n0 0\n0 0\n");
+    read_matrix(zeros, context.matrix);
+    assert(solve_matrix(context).outcome == Outcome::not_reduced);
+
+    // the empty graph left by realizing c0 must not reuse that answer
+    std::istringstream ones("2 1\n1\n1\n");
+    read_matrix(ones, context.matrix);
+    assert(solve_matrix(context).outcome == Outcome::reduced);
+    assert(context.result.realized == std::list<SignedCharacter>({{"c0", State::gain}}));
+
+    general::enabled = false;
+    preprocess::enabled = false;
+    cache::directory.clear();
+
+    remove_directory(directory);
+
+    std::cout << "test_cache_preprocess: passed" << std::endl;
+}
+
+void test_cache_rules() {
+    char directory[] = "/tmp/ppp_cache_XXXXXX";
+    assert(mkdtemp(directory) != nullptr);
+
+    cache::directory = directory;
+
+    // s0: c0 c1, s1: c1 c2, s2: c0 c2 is not reduced by the pending rule alone
+    SolverContext context;
+    rules::order = "pending";
+    std::istringstream first("3 3\n1 1 0\n0 1 1\n1 0 1\n");
+    read_matrix(first, context.matrix);
+    assert(solve_matrix(context).outcome == Outcome::not_reduced);
+
+    // the failure with a subset of the rules is not an answer for all of them
+    rules::order.clear();
+    std::istringstream second("3 3\n1 1 0\n0 1 1\n1 0 1\n");
+    read_matrix(second, context.matrix);
+    assert(solve_matrix(context).outcome == Outcome::reduced);
+    assert(context.result.realized.size() == 5);
+
+    cache::directory.clear();
+    remove_directory(directory);
+
+    std::cout << "test_cache_rules: passed" << std::endl;
+}
+
+void test_timeout_overrun() {
+    // 400x200 matrix with a 1 in about a quarter of the cells, whose maximal
+    // reducible graph takes seconds to extract
+    std::ostringstream os;
+    os << "400 200\n";
+    uint32_t seed = 1;
+    for (size_t i = 0; i < 400; ++i) {
+        for (size_t j = 0; j < 200; ++j) {
+            seed = seed * 1103515245 + 12345;
+            os << ((seed >> 16) % 4 == 0 ? "1 " : "0 ");
+        }
+        os << "\n";
+    }
+
+    timeout::ms = 10;
+
+    SolverContext context;
+    std::istringstream is(os.str());
+    read_matrix(is, context.matrix);
+
+    const auto start = std::chrono::steady_clock::now();
+    assert(solve_matrix(context).outcome == Outcome::timeout);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // the budget is checked within the phases, so it is overrun by little
+    assert(elapsed < std::chrono::milliseconds(500));
+
+    timeout::ms = 0;
+
+    std::cout << "test_timeout_overrun: passed" << std::endl;
+}
+
 void test_closure() {
     RBGraph g, gmf;
     RBVertex s1, s2, s3, s4, c1, c2, c3, c4, c5;
@@ -1459,6 +2655,48 @@ void test_closure() {
     std::cout << "test_closure: passed" << std::endl;
 }
 
+void test_closure_table() {
+    RBGraph g;
+    RBVertex s1, s2, s3, s4, c1, c2, c3, c4, c5;
+    s1 = add_vertex("s1", Type::species, g);
+    s2 = add_vertex("s2", Type::species, g);
+    s3 = add_vertex("s3", Type::species, g);
+    s4 = add_vertex("s4", Type::species, g);
+    c1 = add_vertex("c1", Type::character, g);
+    c2 = add_vertex("c2", Type::character, g);
+    c3 = add_vertex("c3", Type::character, g);
+    c4 = add_vertex("c4", Type::character, g);
+    c5 = add_vertex("c5", Type::character, g);
+    add_edge(c1, s1, Color::black, g);
+    add_edge(c1, s2, Color::black, g);
+    add_edge(c2, s2, Color::black, g);
+    add_edge(c3, s2, Color::black, g);
+    add_edge(c3, s3, Color::black, g);
+    add_edge(c4, s3, Color::black, g);
+    add_edge(c4, s4, Color::black, g);
+    add_edge(c5, s4, Color::black, g);
+
+    const ClosureTable &table = closure_table(g);
+    assert(table.minimal() == std::vector<RBVertex>({c2, c5}));
+    assert(table.closure(s1) == std::list<RBVertex>({c2}));
+    assert(table.closure(s2) == std::list<RBVertex>({c2}));
+    assert(table.closure(s3).empty());
+    assert(table.closure(s4) == std::list<RBVertex>({c5}));
+    // characters have no maximal characters
+    assert(table.closure(c1) == std::list<RBVertex>({c2, c5}));
+
+    // the table is computed once per version of g
+    assert(&closure_table(g) == &table);
+    for (RBVertex s : {s1, s2, s3, s4})
+        assert(closure(s, g) == table.closure(s));
+
+    remove_edge(c2, s2, g);
+    assert(closure(s3, g) == std::list<RBVertex>({c2}));
+    assert(closure_table(g).closure(s4) == std::list<RBVertex>({c2, c5}));
+
+    std::cout << "test_closure_table: passed" << std::endl;
+}
+
 void test_lineTree_property() {
     RBGraph g;
     RBVertex s1, s2, c1, c2;
@@ -1476,6 +2714,199 @@ void test_lineTree_property() {
 
 }
 
+// the LexBFS headers bring namespace std in, whose is_empty would hide the
+// one of the red-black graphs, so they are included after the other tests
+#include "../src/LexBFS-master/src/Graph.h"
+
+// build the LexBFS graph with n vertices and the edges in edges
+static Graph lex_graph(const int n, const std::vector<std::pair<int, int>> &edges) {
+    Graph graph(n, edges.size());
+    for (const auto &e : edges)
+        graph.insertEdge(e.first, e.second);
+    return graph;
+}
+
+void test_lex_bfs() {
+    // the order visited by Lex_BFS, from pi[v] = n - 1 - (visit time of v)
+    auto visit_order = [](Graph &graph, const int n) {
+        int *pi = graph.Lex_BFS();
+        std::vector<int> order(n, -1);
+        for (int v = 0; v < n; ++v) {
+            assert(pi[v] >= 0 && pi[v] < n);
+            assert(order[n - 1 - pi[v]] == -1);
+            order[n - 1 - pi[v]] = v;
+        }
+        delete[] pi;
+        return order;
+    };
+
+    // an order is a LexBFS order if, for a < b < c with a adjacent to c and
+    // not to b, some d < a is adjacent to b and not to c
+    auto is_lex_bfs = [](const std::vector<int> &order, const int n,
+                         const std::vector<std::pair<int, int>> &edges) {
+        std::vector<std::vector<bool>> adj(n, std::vector<bool>(n, false));
+        for (const auto &e : edges)
+            adj[e.first][e.second] = adj[e.second][e.first] = true;
+
+        for (int a = 0; a < n; ++a)
+            for (int b = a + 1; b < n; ++b)
+                for (int c = b + 1; c < n; ++c) {
+                    const int va = order[a], vb = order[b], vc = order[c];
+                    if (!adj[va][vc] || adj[va][vb])
+                        continue;
+
+                    bool found = false;
+                    for (int d = 0; d < a && !found; ++d)
+                        found = (adj[order[d]][vb] && !adj[order[d]][vc]);
+                    if (!found)
+                        return false;
+                }
+        return true;
+    };
+
+    // path 0 - 1 - 2 - 3 is visited from 0 to 3
+    const std::vector<std::pair<int, int>> path = {{0, 1}, {1, 2}, {2, 3}};
+    Graph g_path = lex_graph(4, path);
+    assert(visit_order(g_path, 4) == std::vector<int>({0, 1, 2, 3}));
+
+    // the neighbours of the first vertex come before the others, and the
+    // vertices of a second component come after the first one
+    const std::vector<std::pair<int, int>> split = {{0, 3}, {3, 1}, {2, 4}};
+    Graph g_split = lex_graph(5, split);
+    assert(visit_order(g_split, 5) == std::vector<int>({0, 3, 1, 2, 4}));
+
+    // random graphs, with repeated edges
+    uint32_t seed = 1;
+    auto next = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+    for (size_t k = 0; k < 200; ++k) {
+        const int n = 1 + next() % 8;
+        std::vector<std::pair<int, int>> edges;
+        for (int u = 0; u < n; ++u)
+            for (int v = u + 1; v < n; ++v)
+                if (next() % 3 == 0) {
+                    edges.emplace_back(u, v);
+                    if (next() % 4 == 0)
+                        edges.emplace_back(v, u);
+                }
+
+        Graph graph = lex_graph(n, edges);
+        assert(is_lex_bfs(visit_order(graph, n), n, edges));
+    }
+
+    std::cout << "test_lex_bfs: passed" << std::endl;
+}
+
+void test_is_chordal() {
+    // triangle 0 1 2 and C4 3 4 5 6
+    const std::vector<std::pair<int, int>> triangle = {{0, 1}, {1, 2}, {2, 0}};
+    const std::vector<std::pair<int, int>> c4 = {{3, 4}, {4, 5}, {5, 6}, {6, 3}};
+
+    Graph g_triangle = lex_graph(3, triangle);
+    assert(g_triangle.isChordal());
+
+    // a tree and a graph with no edges are chordal
+    Graph g_tree = lex_graph(5, {{0, 1}, {0, 2}, {2, 3}, {2, 4}});
+    assert(g_tree.isChordal());
+    Graph g_empty = lex_graph(4, {});
+    assert(g_empty.isChordal());
+
+    // K4 and C4 with a chord are chordal
+    Graph g_k4 = lex_graph(4, {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}});
+    assert(g_k4.isChordal());
+    Graph g_chord = lex_graph(4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 2}});
+    assert(g_chord.isChordal());
+
+    // C4 and C5 are not
+    Graph g_c4 = lex_graph(4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}});
+    assert(!g_c4.isChordal());
+    Graph g_c5 = lex_graph(5, {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}});
+    assert(!g_c5.isChordal());
+
+    // C5 with one chord still has a chordless C4
+    Graph g_c5_chord = lex_graph(5, {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}, {0, 2}});
+    assert(!g_c5_chord.isChordal());
+
+    // disconnected: a chordless cycle in any component
+    std::vector<std::pair<int, int>> edges = triangle;
+    edges.insert(edges.end(), c4.begin(), c4.end());
+    Graph g_disconnected = lex_graph(8, edges);
+    assert(!g_disconnected.isChordal());
+
+    Graph g_two_triangles = lex_graph(7, {{0, 1}, {1, 2}, {2, 0}, {4, 5}, {5, 6}, {6, 4}});
+    assert(g_two_triangles.isChordal());
+
+    // repeated edges do not change the answer
+    Graph g_triangle_twice = lex_graph(3, {{0, 1}, {1, 0}, {1, 2}, {2, 0}, {0, 2}, {1, 2}});
+    assert(g_triangle_twice.isChordal());
+    Graph g_c4_twice = lex_graph(4, {{0, 1}, {1, 2}, {2, 1}, {2, 3}, {3, 0}, {0, 3}});
+    assert(!g_c4_twice.isChordal());
+
+    // random graphs, against the removal of simplicial vertices: a graph is
+    // chordal if and only if it can be emptied by removing them
+    auto is_chordal = [](const int n, const std::vector<std::pair<int, int>> &edges) {
+        std::vector<std::set<int>> adj(n);
+        for (const auto &e : edges) {
+            adj[e.first].insert(e.second);
+            adj[e.second].insert(e.first);
+        }
+
+        std::vector<bool> removed(n, false);
+        for (int left = n; left > 0; --left) {
+            int simplicial = -1;
+            for (int v = 0; v < n && simplicial < 0; ++v) {
+                if (removed[v])
+                    continue;
+
+                bool clique = true;
+                for (int a : adj[v])
+                    for (int b : adj[v])
+                        if (a < b && adj[a].count(b) == 0)
+                            clique = false;
+                if (clique)
+                    simplicial = v;
+            }
+            if (simplicial < 0)
+                return false;
+
+            removed[simplicial] = true;
+            for (int u : adj[simplicial])
+                adj[u].erase(simplicial);
+            adj[simplicial].clear();
+        }
+        return true;
+    };
+
+    uint32_t seed = 7;
+    auto next = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+    size_t num_chordal = 0;
+    for (size_t k = 0; k < 500; ++k) {
+        const int n = 1 + next() % 9;
+        std::vector<std::pair<int, int>> random_edges;
+        for (int u = 0; u < n; ++u)
+            for (int v = u + 1; v < n; ++v)
+                if (next() % 5 < 2) {
+                    random_edges.emplace_back(u, v);
+                    if (next() % 4 == 0)
+                        random_edges.emplace_back(u, v);
+                }
+
+        Graph graph = lex_graph(n, random_edges);
+        const bool chordal = is_chordal(n, random_edges);
+        assert(graph.isChordal() == chordal);
+        num_chordal += chordal;
+    }
+    // both answers are covered
+    assert(num_chordal > 0 && num_chordal < 500);
+
+    std::cout << "test_is_chordal: passed" << std::endl;
+}
+
 int main(int argc, char *argv[]) {
     // test_simple_add_vertex();
     // test_get_vertex();
@@ -1492,17 +2923,26 @@ int main(int argc, char *argv[]) {
     // test_get_neighbors();
     // test_map();
     // test_overlap();
+    // test_overlap_graph();
     // test_active();
     // test_components();
     // test_connected();
+    // test_component_index();
     // test_includes();
     // test_maximal();
+    // test_maximal_index();
+    // test_worklists();
+    // test_species_hasse();
+    // test_rule_engine();
+    // test_derived_graphs();
     // test_p_active();
     // test_pending_species();
     // test_realize();
+    // test_realize_split();
     // test_realize_character();
     // test_singletons();
     // test_universal();
+    // test_universal_characters();
     // test_is_degenerate();
     // test_all_species_with_red_edges();
     // test_quasi_active();
@@ -1510,7 +2950,25 @@ int main(int argc, char *argv[]) {
     // test_minimal_form_graph();
     // test_ppp_maximal_reducible_graphs();
     // test_get_matrix_representation();
+    // test_get_sparse_representation();
     // test_01_property();
+    // test_01_property_engines();
+    // test_lex_bfs();
+    // test_is_chordal();
+    // test_canonical_matrix();
+    // test_memo_components();
+    // test_ppp_exponential();
+    // test_bitgraph();
+    // test_deadline();
+    // test_ppp_solve();
+    // test_reduce_matrix();
+    // test_perfect_phylogeny();
+    // test_conflict_components();
+    // test_solver_context();
+    // test_cache_preprocess();
+    // test_cache_rules();
+    // test_timeout_overrun();
     // test_closure();
+    // test_closure_table();
     test_lineTree_property();
 }
\ No newline at end of file
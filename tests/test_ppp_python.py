@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Tests of the Python bindings, against the results of the ppp executable.
+
+Build the module and the executable with "make python" and "make", then run
+"python3 tests/test_ppp_python.py" from the root of the repository.
+"""
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+import numpy
+import scipy.sparse
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, os.path.join(ROOT, "bin"))
+
+import ppp  # noqa: E402
+
+
+def run_cli(matrix):
+    """Return the status and the realized characters printed by ppp.exe on matrix."""
+    with tempfile.NamedTemporaryFile("w", suffix=".txt", delete=False) as f:
+        f.write("%d %d\n" % matrix.shape)
+        for row in matrix:
+            f.write(" ".join("1" if x else "0" for x in row) + "\n")
+
+    try:
+        output = subprocess.run([os.path.join(ROOT, "bin", "ppp.exe"), f.name],
+                                stdout=subprocess.PIPE, universal_newlines=True, check=True).stdout
+    finally:
+        os.remove(f.name)
+
+    result = [line for line in output.splitlines() if line.startswith("[RES]")]
+    assert len(result) == 1, output
+
+    if "[OK]" not in result[0]:
+        return "not_reduced", []
+
+    return "reduced", re.findall(r"\((c\d+[+-])\)", result[0])
+
+
+def run_module(matrix):
+    """Return the status and the realized characters of ppp.solve on matrix."""
+    result = ppp.solve(matrix)
+    return result.status.name, ["c%d%s" % (sc.character, "+" if sc.gain else "-")
+                                for sc in result.realized]
+
+
+# s0: c2 c3 c4, s1: c0 c1 c2, s2: c0 c1 c3 c4, s3: c3 c4
+DENSE = numpy.array([[0, 0, 1, 1, 1], [1, 1, 1, 0, 0], [1, 1, 0, 1, 1], [0, 0, 0, 1, 1]],
+                    dtype=numpy.bool_)
+
+# s0: c0 c1, s1: c1 c2, s2: c0 c2
+CYCLE = numpy.array([[1, 1, 0], [0, 1, 1], [1, 0, 1]], dtype=numpy.uint8)
+
+# s0: c0 c1 c2, s1: c0 c1, s2: c0 c2, s3: c3
+NESTED = numpy.array([[1, 1, 1, 0], [1, 1, 0, 0], [1, 0, 1, 0], [0, 0, 0, 1]], dtype=numpy.uint8)
+
+
+def test_dense():
+    expected = run_cli(DENSE)
+    assert expected[0] == "reduced"
+    assert run_module(DENSE) == expected
+
+    # a list of lists is converted to an array of uint8
+    assert run_module(DENSE.astype(numpy.uint8).tolist()) == expected
+
+    print("test_dense: passed")
+
+
+def test_strided():
+    # every other row, and every third column from the last one: the column
+    # stride is negative and the rows are not contiguous
+    base = numpy.zeros((2 * CYCLE.shape[0], 3 * CYCLE.shape[1]), dtype=numpy.uint8)
+    view = base[::2, ::-3]
+    view[...] = CYCLE
+    assert view.strides[0] > 0 and view.strides[1] < 0
+    assert not view.flags.c_contiguous and not view.flags.f_contiguous
+
+    expected = run_cli(CYCLE)
+    assert expected[0] == "reduced"
+    assert run_module(view) == expected
+
+    # a transposed array has its rows in the columns
+    transposed = numpy.ascontiguousarray(NESTED.T).T
+    assert not transposed.flags.c_contiguous
+    assert run_module(transposed) == run_cli(NESTED)
+
+    print("test_strided: passed")
+
+
+def test_csr():
+    # the explicit zeros are stored entries that are not edges
+    indptr, indices, data = [0], [], []
+    for row in NESTED:
+        for j, x in enumerate(row):
+            if x or j == len(row) - 1:
+                indices.append(j)
+                data.append(x)
+        indptr.append(len(indices))
+
+    for index_type in (numpy.int32, numpy.int64):
+        csr = scipy.sparse.csr_matrix(
+                (numpy.array(data, dtype=numpy.uint8), numpy.array(indices, dtype=index_type),
+                 numpy.array(indptr, dtype=index_type)),
+                shape=NESTED.shape)
+        assert csr.nnz > numpy.count_nonzero(NESTED)
+        assert run_module(csr) == run_cli(NESTED)
+
+    # an indptr past the stored entries is rejected
+    bad = scipy.sparse.csr_matrix(NESTED)
+    bad.indptr = bad.indptr.copy()
+    bad.indptr[-1] += 1
+    try:
+        ppp.solve(bad)
+        assert False, "invalid indptr accepted"
+    except ValueError:
+        pass
+
+    print("test_csr: passed")
+
+
+def test_threads():
+    # a 400x200 matrix takes long enough to see whether the GIL is held
+    matrix = (numpy.random.default_rng(1).random((400, 200)) < 0.25).astype(numpy.uint8)
+    expected = run_cli(matrix)
+
+    # a thread ticking while the matrices are solved, which would stop for a
+    # whole solve if the GIL was held
+    done = threading.Event()
+    longest_gap = [0.0]
+
+    def tick():
+        last = time.monotonic()
+        while not done.is_set():
+            now = time.monotonic()
+            longest_gap[0] = max(longest_gap[0], now - last)
+            last = now
+
+    results = [None] * 2
+
+    def solve(i):
+        results[i] = run_module(matrix)
+
+    ticker = threading.Thread(target=tick)
+    ticker.start()
+
+    start = time.monotonic()
+    threads = [threading.Thread(target=solve, args=(i,)) for i in range(len(results))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.monotonic() - start
+
+    done.set()
+    ticker.join()
+
+    assert results == [expected] * len(results)
+    assert longest_gap[0] < elapsed / 2, (longest_gap[0], elapsed)
+
+    print("test_threads: passed")
+
+
+if __name__ == "__main__":
+    test_dense()
+    test_strided()
+    test_csr()
+    test_threads()